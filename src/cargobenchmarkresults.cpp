@@ -0,0 +1,242 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargobenchmarkresults.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QSaveFile>
+
+#include <interfaces/iproject.h>
+
+#include "cargoplugin.h"
+#include "debug.h"
+
+using namespace KDevelop;
+
+namespace
+{
+
+QJsonObject readJsonFile(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QJsonObject();
+    }
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+/// Numbers in libtest's output are grouped with commas, such as "1,234.5"
+double parseLibtestNumber(QString number, bool* ok)
+{
+    return number.remove(QLatin1Char(',')).toDouble(ok);
+}
+
+}
+
+CargoBenchmarkResults::CargoBenchmarkResults(const QString& fileName)
+ : m_fileName(fileName)
+{
+}
+
+QString CargoBenchmarkResults::fileName(IProject* project)
+{
+    return CargoPlugin::dataDirectory(project) + QStringLiteral("/benchmarks.json");
+}
+
+QString CargoBenchmarkResults::criterionDirectory(IProject* project)
+{
+    // The target directory, where `cargo bench` lets Criterion write them as well
+    return QFileInfo(CargoPlugin::dataDirectory(project)).path() + QStringLiteral("/criterion");
+}
+
+void CargoBenchmarkResults::addEstimates(const QVector<Estimate>& estimates)
+{
+    if (estimates.isEmpty())
+    {
+        return;
+    }
+
+    QJsonObject results = load();
+    for (const auto& estimate : estimates)
+    {
+        QJsonObject suite = results.value(estimate.suiteName).toObject();
+        const QJsonObject previous = suite.value(estimate.benchmarkName).toObject();
+
+        QJsonObject benchmark;
+        benchmark.insert(QStringLiteral("time"), estimate.time);
+        benchmark.insert(QStringLiteral("lower"), estimate.lowerBound);
+        benchmark.insert(QStringLiteral("upper"), estimate.upperBound);
+        benchmark.insert(QStringLiteral("confidence"), estimate.confidenceLevel);
+        benchmark.insert(QStringLiteral("measured"), estimate.measured.toMSecsSinceEpoch());
+        if (previous.contains(QStringLiteral("time")))
+        {
+            benchmark.insert(QStringLiteral("previous"), previous.value(QStringLiteral("time")));
+        }
+        suite.insert(estimate.benchmarkName, benchmark);
+        results.insert(estimate.suiteName, suite);
+    }
+    store(results);
+}
+
+QVector<CargoBenchmarkResults::Estimate> CargoBenchmarkResults::estimates() const
+{
+    QVector<Estimate> estimates;
+    const QJsonObject results = load();
+    for (auto it = results.constBegin(); it != results.constEnd(); ++it)
+    {
+        const QJsonObject suite = it.value().toObject();
+        for (auto benchmarkIt = suite.constBegin(); benchmarkIt != suite.constEnd(); ++benchmarkIt)
+        {
+            const QJsonObject benchmark = benchmarkIt.value().toObject();
+            estimates << Estimate{
+                it.key(),
+                benchmarkIt.key(),
+                benchmark.value(QStringLiteral("time")).toDouble(),
+                benchmark.value(QStringLiteral("lower")).toDouble(),
+                benchmark.value(QStringLiteral("upper")).toDouble(),
+                benchmark.value(QStringLiteral("confidence")).toDouble(),
+                benchmark.value(QStringLiteral("previous")).toDouble(-1),
+                QDateTime::fromMSecsSinceEpoch(qint64(benchmark.value(QStringLiteral("measured")).toDouble()))
+            };
+        }
+    }
+    return estimates;
+}
+
+bool CargoBenchmarkResults::parseLibtestLine(const QString& line, Estimate* estimate)
+{
+    // Newer toolchains print fractions of nanoseconds, and benchmarks that set bytes add a throughput after the spread
+    static const QRegularExpression pattern(QStringLiteral("^test (\\S+) \\.\\.\\. bench:\\s+([0-9,.]+) ns/iter \\(\\+/- ([0-9,.]+)\\)"));
+    const QRegularExpressionMatch match = pattern.match(line);
+    if (!match.hasMatch())
+    {
+        return false;
+    }
+
+    bool timeOk = false;
+    bool spreadOk = false;
+    const double time = parseLibtestNumber(match.captured(2), &timeOk);
+    const double spread = parseLibtestNumber(match.captured(3), &spreadOk);
+    if (!timeOk || !spreadOk)
+    {
+        return false;
+    }
+
+    estimate->benchmarkName = match.captured(1);
+    estimate->time = time;
+    estimate->lowerBound = qMax(0.0, time - spread);
+    estimate->upperBound = time + spread;
+    estimate->confidenceLevel = 0;
+    return true;
+}
+
+QVector<CargoBenchmarkResults::Estimate> CargoBenchmarkResults::readCriterionEstimates(const QString& directory, const QDateTime& since)
+{
+    QVector<Estimate> estimates;
+
+    // Every benchmark has its own directory, with the latest measurement in new/
+    QDirIterator it(directory, { QStringLiteral("benchmark.json") }, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        const QFileInfo info(it.next());
+        if (info.dir().dirName() != QLatin1String("new"))
+        {
+            continue;
+        }
+
+        const QString estimatesFile = info.dir().filePath(QStringLiteral("estimates.json"));
+        const QDateTime measured = QFileInfo(estimatesFile).lastModified();
+        // File systems may keep modification times only to the second
+        if (!measured.isValid() || (since.isValid() && measured.toMSecsSinceEpoch() / 1000 < since.toMSecsSinceEpoch() / 1000))
+        {
+            continue;
+        }
+
+        const QString name = readJsonFile(info.filePath()).value(QStringLiteral("full_id")).toString();
+        const QJsonObject values = readJsonFile(estimatesFile);
+        QJsonObject statistic = values.value(QStringLiteral("slope")).toObject();
+        if (statistic.isEmpty())
+        {
+            statistic = values.value(QStringLiteral("mean")).toObject();
+        }
+        if (name.isEmpty() || statistic.isEmpty())
+        {
+            qCDebug(KDEV_CARGO) << "Could not read Criterion estimates from" << info.path();
+            continue;
+        }
+
+        const QJsonObject interval = statistic.value(QStringLiteral("confidence_interval")).toObject();
+        estimates << Estimate{
+            QString(),
+            name,
+            statistic.value(QStringLiteral("point_estimate")).toDouble(),
+            interval.value(QStringLiteral("lower_bound")).toDouble(),
+            interval.value(QStringLiteral("upper_bound")).toDouble(),
+            interval.value(QStringLiteral("confidence_level")).toDouble(),
+            -1,
+            measured
+        };
+    }
+    return estimates;
+}
+
+QString CargoBenchmarkResults::formatTime(double nanoseconds)
+{
+    if (nanoseconds >= 1e9)
+    {
+        return QStringLiteral("%1 s").arg(nanoseconds / 1e9, 0, 'f', 3);
+    }
+    else if (nanoseconds >= 1e6)
+    {
+        return QStringLiteral("%1 ms").arg(nanoseconds / 1e6, 0, 'f', 3);
+    }
+    else if (nanoseconds >= 1e3)
+    {
+        return QStringLiteral("%1 µs").arg(nanoseconds / 1e3, 0, 'f', 3);
+    }
+    return QStringLiteral("%1 ns").arg(nanoseconds, 0, 'f', 2);
+}
+
+QJsonObject CargoBenchmarkResults::load() const
+{
+    return readJsonFile(m_fileName);
+}
+
+bool CargoBenchmarkResults::store(const QJsonObject& results) const
+{
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(KDEV_CARGO) << "Could not write benchmark results" << m_fileName << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(results).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOBENCHMARKRESULTS_H
+#define CARGOBENCHMARKRESULTS_H
+
+#include <QDateTime>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+namespace KDevelop
+{
+class IProject;
+}
+
+/**
+ * The latest estimate of every benchmark of a project, kept in the target directory across sessions.
+ *
+ * Benchmarks built with the libtest harness report their time as "bench: N ns/iter (+/- M)" lines,
+ * where M is the spread of the samples. Criterion writes its estimates with confidence intervals
+ * to JSON files in its own directory, which are read once the benchmarks are done.
+ */
+class CargoBenchmarkResults
+{
+public:
+    /// The time of one iteration of a benchmark, in nanoseconds
+    struct Estimate
+    {
+        QString suiteName;
+        QString benchmarkName;
+        double time;
+        double lowerBound;
+        double upperBound;
+        /// The confidence level of the bounds, 0 if they are the spread of the samples reported by libtest
+        double confidenceLevel;
+        /// The estimate before this one, or -1 if there was none
+        double previousTime;
+        QDateTime measured;
+    };
+
+    explicit CargoBenchmarkResults(const QString& fileName);
+
+    /// @return the results file of @p project
+    static QString fileName(KDevelop::IProject* project);
+
+    /// @return the directory Criterion is told to write its estimates to, for @p project
+    static QString criterionDirectory(KDevelop::IProject* project);
+
+    /// Records @p estimates, which replace earlier estimates of the same benchmarks
+    void addEstimates(const QVector<Estimate>& estimates);
+
+    QVector<Estimate> estimates() const;
+
+    /**
+     * Parses a libtest result line such as "test parse ... bench:       1,234 ns/iter (+/- 56)".
+     *
+     * @return whether @p line is a benchmark result, in which case the name, time and bounds of @p estimate are set
+     */
+    static bool parseLibtestLine(const QString& line, Estimate* estimate);
+
+    /**
+     * Reads the estimates Criterion wrote below @p directory, for benchmarks measured at or after @p since,
+     * or for all benchmarks if @p since is invalid.
+     *
+     * The time is Criterion's slope estimate if it sampled linearly, and the mean otherwise,
+     * which is the time Criterion shows itself.
+     */
+    static QVector<Estimate> readCriterionEstimates(const QString& directory, const QDateTime& since);
+
+    /// @return @p nanoseconds in the largest unit that keeps the value above 1, such as "1.23 µs"
+    static QString formatTime(double nanoseconds);
+
+private:
+    QJsonObject load() const;
+    bool store(const QJsonObject& results) const;
+
+    QString m_fileName;
+};
+
+#endif
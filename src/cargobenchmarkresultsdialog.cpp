@@ -0,0 +1,93 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargobenchmarkresultsdialog.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include <KLocalizedString>
+
+CargoBenchmarkResultsDialog::CargoBenchmarkResultsDialog(const CargoBenchmarkResults& results, QWidget* parent)
+ : QDialog(parent)
+{
+    setWindowTitle(i18n("Cargo Benchmark Results"));
+
+    auto label = new QLabel(i18n("Times of one iteration of each benchmark. Criterion reports bounds with their confidence level, "
+                                 "libtest reports the spread of its samples."), this);
+    label->setWordWrap(true);
+
+    auto tree = new QTreeWidget(this);
+    tree->setRootIsDecorated(false);
+    tree->setAlternatingRowColors(true);
+
+    const QStringList headers = { i18n("Suite"), i18n("Benchmark"), i18n("Time (ns)"), i18n("Lower Bound (ns)"),
+                                  i18n("Upper Bound (ns)"), i18n("Confidence (%)"), i18n("Change (%)"), i18n("Measured") };
+    tree->setHeaderLabels(headers);
+
+    enum { TimeColumn = 2, ChangeColumn = 6, MeasuredColumn = 7 };
+
+    for (const auto& estimate : results.estimates())
+    {
+        auto item = new QTreeWidgetItem(tree);
+        item->setText(0, estimate.suiteName);
+        item->setText(1, estimate.benchmarkName);
+
+        // Numbers are set as data, so that the columns sort numerically
+        item->setData(TimeColumn, Qt::DisplayRole, estimate.time);
+        item->setData(TimeColumn + 1, Qt::DisplayRole, estimate.lowerBound);
+        item->setData(TimeColumn + 2, Qt::DisplayRole, estimate.upperBound);
+        if (estimate.confidenceLevel > 0)
+        {
+            item->setData(TimeColumn + 3, Qt::DisplayRole, qRound(estimate.confidenceLevel * 100));
+        }
+        if (estimate.previousTime > 0)
+        {
+            item->setData(ChangeColumn, Qt::DisplayRole, qRound((estimate.time / estimate.previousTime - 1) * 1000) / 10.0);
+        }
+        item->setData(MeasuredColumn, Qt::DisplayRole, estimate.measured);
+
+        // The tooltip shows the time in a readable unit
+        item->setToolTip(TimeColumn, CargoBenchmarkResults::formatTime(estimate.time));
+        for (int column = TimeColumn; column < MeasuredColumn; ++column)
+        {
+            item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+
+    tree->setSortingEnabled(true);
+    tree->sortByColumn(TimeColumn, Qt::DescendingOrder);
+    tree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(label);
+    layout->addWidget(tree);
+    layout->addWidget(buttons);
+
+    resize(900, 500);
+}
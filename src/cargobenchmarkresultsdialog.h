@@ -0,0 +1,43 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOBENCHMARKRESULTSDIALOG_H
+#define CARGOBENCHMARKRESULTSDIALOG_H
+
+#include <QDialog>
+
+#include "cargobenchmarkresults.h"
+
+/**
+ * Shows the latest estimate of every benchmark of a project from its CargoBenchmarkResults,
+ * with its bounds and its change since the estimate before.
+ *
+ * The list starts sorted by time, and can be sorted by any column.
+ */
+class CargoBenchmarkResultsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    CargoBenchmarkResultsDialog(const CargoBenchmarkResults& results, QWidget* parent = nullptr);
+};
+
+#endif
@@ -22,144 +22,51 @@
 
 #include "cargobuildjob.h"
 
+#include <KConfigGroup>
 #include <KLocalizedString>
 #include <KShell>
 
 #include <interfaces/iproject.h>
 #include <outputview/outputmodel.h>
 #include <outputview/outputdelegate.h>
-#include <outputview/filtereditem.h>
-#include <outputview/outputfilteringstrategies.h>
-#include <util/commandexecutor.h>
 #include <project/projectmodel.h>
 
+#include <QSet>
+#include <QStandardPaths>
+#include <QThread>
+
 #include "cargoplugin.h"
+#include "cargofilterstrategy.h"
+#include "cargooutputmodel.h"
+#include "cargooutputpipeline.h"
+#include "cargoproblemreporter.h"
 
 using namespace KDevelop;
 
-class CargoFilterStrategy : public KDevelop::IFilterStrategy
-{
-public:
-    explicit CargoFilterStrategy(const QUrl& buildDir);
-    virtual ~CargoFilterStrategy();
-
-    FilteredItem errorInLine(const QString& line) override;
-    FilteredItem actionInLine(const QString& line) override;
-
-private:
-    KDevelop::Path buildDir;
-    QString currentFile;
-    KDevelop::FilteredItem::FilteredOutputItemType currentItemType;
-};
-
-CargoFilterStrategy::CargoFilterStrategy(const QUrl& buildDir)
- : buildDir(buildDir)
-{
-}
-
-CargoFilterStrategy::~CargoFilterStrategy()
-{
-}
-
-KDevelop::FilteredItem CargoFilterStrategy::errorInLine(const QString& line)
-{
-    KDevelop::FilteredItem item(line);
-    if (line.startsWith(QStringLiteral("error:")) || line.startsWith(QStringLiteral("error[")))
-    {
-        item.type = FilteredItem::ErrorItem;
-    }
-    else if (line.startsWith(QStringLiteral("warning:")) || line.startsWith(QStringLiteral("warning[")))
-    {
-        item.type = FilteredItem::WarningItem;
-    }
-    else if (line.startsWith(QStringLiteral("   Compiling"))
-            || line.startsWith(QStringLiteral("    Finished")))
-    {
-        item.type = FilteredItem::ActionItem;
-    }
-    else
-    {
-        QStringList elements = line.split(' ', QString::SkipEmptyParts);
-        if (elements.size() > 1 && elements[0] == QStringLiteral("-->"))
-        {
-            item.type = currentItemType;
-            QStringList location = elements[1].split(':');
-            if (location.size() > 0)
-            {
-                currentFile = location[0];
-
-                item.isActivatable = true;
-                item.url = Path(buildDir, currentFile).toUrl();
-                if (location.size() > 1)
-                {
-                    /*
-                     * Cargo counts lines from 1, and so does Kate,
-                     * but KDevelop internally counts from 0,
-                     * so we have to decrement the line number by 1.
-                     * The same is true for column numbers.
-                     */
-                    item.lineNo = location[1].toInt() - 1;
-                }
-                if (location.size() > 2)
-                {
-                    item.columnNo = location[2].toInt() - 1;
-                }
-            }
-        }
-        else if (elements.size() >= 1 && (elements[0] == '|' || elements[0] == '='))
-        {
-            item.type = FilteredItem::InformationItem;
-        }
-        else if (elements.size() >= 2 && elements[1] == '|')
-        {
-            item.type = FilteredItem::InformationItem;
-            item.isActivatable = true;
-            item.url = Path(buildDir, currentFile).toUrl();
-            item.lineNo = elements[0].toInt() - 1;
-
-            /*
-             * We determine the column number from the line itself,
-             * as the first non-space character after the line number and '|'.
-             */
-            int idx = elements[0].size() + 3;
-            int length = line.size();
-
-            item.columnNo = 0;
-            for (int i = idx; i < length; ++i)
-            {
-                if (!line[i].isSpace())
-                {
-                    item.columnNo = i - idx;
-                    break;
-                }
-            }
-        }
-        else
-        {
-            item.type = FilteredItem::StandardItem;
-        }
-    }
-    currentItemType = item.type;
-    return item;
-}
-
-KDevelop::FilteredItem CargoFilterStrategy::actionInLine(const QString& line)
-{
-    return KDevelop::FilteredItem(line);
-}
-
-
 CargoBuildJob::CargoBuildJob( CargoPlugin* plugin, KDevelop::ProjectBaseItem* item, const QString& command )
     : OutputJob( plugin )
     , command( command)
-    , executor(nullptr)
+    , outputThread(nullptr)
+    , pipeline(nullptr)
+    , problemReporter( plugin->problemReporter() )
+    , problemBuild( -1 )
     , killed( false )
     , enabled( false )
+    , jsonDiagnostics( false )
+    , lowPriority( false )
+    , outputLimit( 0 )
 {
     setCapabilities( Killable );
     QString subgrpname;
     projectName = item->project()->name();
     builddir = plugin->buildDirectory( item ).toLocalFile();
+    logDirectory = plugin->targetDirectory( item->project() ).toLocalFile() + QStringLiteral("/kdevelop");
+
+    KConfigGroup config( item->project()->projectConfiguration(), "Cargo" );
+    if (config.readEntry( "Limit Output", false ))
+    {
+        outputLimit = config.readEntry( "Output Lines", 10000 );
+    }
 
     cmd = "cargo";
 
@@ -170,6 +77,27 @@ CargoBuildJob::CargoBuildJob( CargoPlugin* plugin, KDevelop::ProjectBaseItem* it
     standardViewType = KDevelop::IOutputView::BuildView;
 }
 
+namespace
+{
+
+/// Log files of running jobs, so that concurrent jobs with the same command do not write to the same file
+QSet<QString> usedLogFiles;
+
+}
+
+CargoBuildJob::~CargoBuildJob()
+{
+    endProblemReport( false );
+    usedLogFiles.remove( logFile );
+
+    if (outputThread)
+    {
+        // The pipeline is deleted, and its process killed, when the thread finishes
+        outputThread->quit();
+        outputThread->wait();
+    }
+}
+
 void CargoBuildJob::start()
 {
     if (command.isEmpty())
@@ -192,40 +120,120 @@ void CargoBuildJob::start()
             arguments << runArguments;
         }
 
+        if (jsonDiagnostics)
+        {
+            // Options after "--" belong to the program run by cargo, not to cargo itself
+            int separator = arguments.indexOf(QStringLiteral("--"));
+            arguments.insert(separator < 0 ? arguments.size() : separator, QStringLiteral("--message-format=json"));
+        }
+
+        QString program = cmd;
+        if (lowPriority)
+        {
+            // Background jobs should not slow down the editor, or other builds
+            const QString nice = QStandardPaths::findExecutable(QStringLiteral("nice"));
+            const QString ionice = QStandardPaths::findExecutable(QStringLiteral("ionice"));
+            if (!ionice.isEmpty())
+            {
+                arguments.prepend(program);
+                arguments = QStringList{ QStringLiteral("-c"), QStringLiteral("3") } + arguments;
+                program = ionice;
+            }
+            if (!nice.isEmpty())
+            {
+                arguments.prepend(program);
+                arguments = QStringList{ QStringLiteral("-n"), QStringLiteral("19") } + arguments;
+                program = nice;
+            }
+        }
+
         setStandardToolView( standardViewType );
         setBehaviours( KDevelop::IOutputView::AllowUserClose | KDevelop::IOutputView::AutoScroll );
         QUrl buildUrl = QUrl::fromLocalFile(builddir);
-        KDevelop::OutputModel* model = new KDevelop::OutputModel(buildUrl);
-        model->setFilteringStrategy(new CargoFilterStrategy(buildUrl));
-        setModel( model );
+        const QString commandLine = QStringLiteral("%1> %2 %3").arg( builddir ).arg( program ).arg( KShell::joinArgs(arguments) );
 
-        startOutput();
+        /*
+         * Process output is read and classified in a separate thread,
+         * and only handed to the model in batches, to keep the UI responsive.
+         */
+        if (outputLimit > 0)
+        {
+            // Only the tail of the output is kept in memory, the rest can be read from the log file
+            const QString logFile = claimLogFile();
+            pipeline = new CargoOutputPipeline( program, arguments, builddir, jsonDiagnostics );
+            pipeline->setLogFile( logFile, commandLine );
+
+            auto model = new CargoOutputModel( buildUrl, outputLimit, logFile );
+            connect( pipeline, &CargoOutputPipeline::itemsReady, model, &CargoOutputModel::appendItems );
+            setModel( model );
+        }
+        else
+        {
+            // OutputModel classifies lines itself, so its filter strategy takes the pipeline's items from a queue
+            classifiedItems.reset(new CargoClassifiedItems);
+            pipeline = new CargoOutputPipeline( program, arguments, builddir, jsonDiagnostics, classifiedItems );
+
+            auto model = new KDevelop::OutputModel( buildUrl );
+            model->setFilteringStrategy( new CargoFilterStrategy( buildUrl, classifiedItems ) );
+            connect( pipeline, &CargoOutputPipeline::linesReady, model, &OutputModel::appendLines );
+            setModel( model );
+        }
 
-        executor = new KDevelop::CommandExecutor( cmd, this );
+        startOutput();
 
-        executor->setArguments( arguments );
-        executor->setWorkingDirectory( builddir );
-        
-        connect( executor, &CommandExecutor::completed, this, &CargoBuildJob::procFinished );
-        connect( executor, &CommandExecutor::failed, this, &CargoBuildJob::procError );
+        outputThread = new QThread( this );
+        pipeline->moveToThread( outputThread );
 
-        connect( executor, &CommandExecutor::receivedStandardError, model, &OutputModel::appendLines );
-        connect( executor, &CommandExecutor::receivedStandardOutput, model, &OutputModel::appendLines );
+        connect( outputThread, &QThread::started, pipeline, &CargoOutputPipeline::start );
+        connect( outputThread, &QThread::finished, pipeline, &QObject::deleteLater );
+        if (jsonDiagnostics && problemReporter)
+        {
+            problemBuild = problemReporter->beginBuild( diagnosticsScope.isValid() ? diagnosticsScope : Path(builddir) );
+            connect( pipeline, &CargoOutputPipeline::diagnosticsReady, this, [this](const QVector<CargoDiagnostic>& diagnostics) {
+                if (problemReporter)
+                {
+                    problemReporter->addDiagnostics( problemBuild, diagnostics );
+                }
+            });
+        }
+        connect( pipeline, &CargoOutputPipeline::artifactsReady, this, [this](const QVector<CargoArtifact>& artifacts) {
+            builtArtifacts += artifacts;
+        });
+        connect( pipeline, &CargoOutputPipeline::processFinished, this, &CargoBuildJob::procFinished );
+        connect( pipeline, &CargoOutputPipeline::processFailed, this, [this](int error) {
+            procError( static_cast<QProcess::ProcessError>(error) );
+        });
+
+        appendLine( commandLine );
+        outputThread->start();
+    }
+}
 
-        model->appendLine( QStringLiteral("%1> %2 %3").arg( builddir ).arg( cmd ).arg( KShell::joinArgs(arguments) ) );
-        executor->start();
+QString CargoBuildJob::claimLogFile()
+{
+    // Files are numbered only while another job of the same command is running, so they do not pile up
+    logFile = QStringLiteral("%1/%2.log").arg( logDirectory, command );
+    for (int i = 2; usedLogFiles.contains( logFile ); ++i)
+    {
+        logFile = QStringLiteral("%1/%2-%3.log").arg( logDirectory, command ).arg( i );
     }
+    usedLogFiles.insert( logFile );
+    return logFile;
 }
 
 bool CargoBuildJob::doKill()
 {
     killed = true;
-    executor->kill();
+    if (pipeline)
+    {
+        QMetaObject::invokeMethod( pipeline, "kill", Qt::QueuedConnection );
+    }
     return true;
 }
 
 void CargoBuildJob::procError( QProcess::ProcessError err )
 {
+    endProblemReport( false );
     if( !killed ) {
         if( err == QProcess::FailedToStart ) {
             setError( FailedToStart );
@@ -241,20 +249,42 @@ void CargoBuildJob::procError( QProcess::ProcessError err )
     emitResult();
 }
 
-KDevelop::OutputModel* CargoBuildJob::model()
+void CargoBuildJob::endProblemReport( bool complete )
+{
+    if (problemBuild >= 0 && problemReporter)
+    {
+        problemReporter->endBuild( problemBuild, complete );
+    }
+    problemBuild = -1;
+}
+
+void CargoBuildJob::appendLine( const QString& line )
 {
-    return qobject_cast<KDevelop::OutputModel*>( OutputJob::model() );
+    if (auto outputModel = qobject_cast<KDevelop::OutputModel*>( model() ))
+    {
+        outputModel->appendLine( line );
+    }
+    else if (auto cargoModel = qobject_cast<CargoOutputModel*>( model() ))
+    {
+        cargoModel->appendLine( line );
+    }
 }
 
 void CargoBuildJob::procFinished(int code)
 {
+    /*
+     * A failed build stops compiling crates after the first error,
+     * so it cannot tell which of the old diagnostics are fixed.
+     */
+    endProblemReport( code == 0 && !killed );
+
     //TODO: Make this configurable when the first report comes in from a tool
     //      where non-zero does not indicate error status
     if( code != 0 ) {
         setError( FailedShownError );
-        model()->appendLine( i18n( "*** Failed ***" ) );
+        appendLine( i18n( "*** Failed ***" ) );
     } else {
-        model()->appendLine( i18n( "*** Finished ***" ) );
+        appendLine( i18n( "*** Finished ***" ) );
     }
     emitResult();
 }
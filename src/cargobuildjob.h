@@ -24,14 +24,22 @@
 #define CARGOBUILDJOB_H
 
 #include <outputview/outputjob.h>
+#include <util/path.h>
+#include <QPointer>
 #include <QProcess>
+#include <QSharedPointer>
 #include <QUrl>
 
+#include "cargomessageparser.h"
+
+class QThread;
 class CargoPlugin;
+class CargoOutputPipeline;
+class CargoClassifiedItems;
+class CargoProblemReporter;
 namespace KDevelop
 {
 class ProjectBaseItem;
-class CommandExecutor;
 class OutputModel;
 class IProject;
 }
@@ -51,6 +59,7 @@ public:
     };
 
     CargoBuildJob( CargoPlugin*, KDevelop::ProjectBaseItem*, const QString& command );
+    ~CargoBuildJob() override;
     void start() override;
     bool doKill() override;
 
@@ -58,21 +67,53 @@ public:
     void setRunArguments(const QStringList &arguments) { this->runArguments = arguments; }
     void setStandardViewType(KDevelop::IOutputView::StandardToolView view) { this->standardViewType = view; }
 
+    /**
+     * Run cargo with --message-format=json and take diagnostics from its JSON messages
+     * instead of guessing them from the human-readable output.
+     */
+    void setJsonDiagnostics(bool enabled) { this->jsonDiagnostics = enabled; }
+
+    /**
+     * Only diagnostics in files below @p directory are considered fixed
+     * when a successful build does not report them again. Defaults to the build directory.
+     */
+    void setDiagnosticsScope(const KDevelop::Path& directory) { this->diagnosticsScope = directory; }
+
+    /// Run cargo with the lowest CPU and IO priority, if nice and ionice are available
+    void setLowPriority(bool enabled) { this->lowPriority = enabled; }
+
+    /// Everything cargo reported as built, or as up to date, if JSON diagnostics are enabled
+    QVector<CargoArtifact> artifacts() const { return this->builtArtifacts; }
+
 private slots:
     void procFinished(int);
     void procError( QProcess::ProcessError );
 private:
-    KDevelop::OutputModel* model();
+    void appendLine(const QString& line);
+    void endProblemReport(bool complete);
+    QString claimLogFile();
     QString command;
     QString projectName;
     QString cmd;
     QString environment;
     QString builddir;
+    /// The full output log, which is unique among running jobs, empty until it is claimed
+    QString logFile;
+    QString logDirectory;
     QUrl installPrefix;
     QStringList runArguments;
-    KDevelop::CommandExecutor* executor;
+    QThread* outputThread;
+    CargoOutputPipeline* pipeline;
+    QSharedPointer<CargoClassifiedItems> classifiedItems;
+    QPointer<CargoProblemReporter> problemReporter;
+    int problemBuild;
     bool killed;
     bool enabled;
+    bool jsonDiagnostics;
+    bool lowPriority;
+    KDevelop::Path diagnosticsScope;
+    QVector<CargoArtifact> builtArtifacts;
+    int outputLimit;
     KDevelop::IOutputView::StandardToolView standardViewType;
 };
 
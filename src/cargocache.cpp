@@ -0,0 +1,148 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargocache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#include "debug.h"
+
+namespace
+{
+
+const int CacheVersion = 1;
+
+bool isUnchanged(const QJsonObject& stamp)
+{
+    // Files that did not exist when the cache was stored have no size
+    const QFileInfo info(stamp.value(QStringLiteral("path")).toString());
+    if (!info.exists() || !stamp.contains(QStringLiteral("size")))
+    {
+        return !info.exists() && !stamp.contains(QStringLiteral("size"));
+    }
+
+    if (info.size() == stamp.value(QStringLiteral("size")).toDouble()
+        && info.lastModified().toMSecsSinceEpoch() == stamp.value(QStringLiteral("mtime")).toDouble())
+    {
+        return true;
+    }
+
+    // The file was touched or saved without changes, which happens a lot with manifests
+    const QString hash = stamp.value(QStringLiteral("hash")).toString();
+    return !hash.isEmpty() && CargoCache::hashFile(info.filePath()).toHex() == hash.toLatin1();
+}
+
+}
+
+CargoCache::CargoCache(const QString& fileName)
+    : m_fileName(fileName)
+{
+}
+
+QString CargoCache::fileName() const
+{
+    return m_fileName;
+}
+
+QByteArray CargoCache::hashFile(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    return hash.result();
+}
+
+QJsonObject CargoCache::load() const
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QJsonObject();
+    }
+
+    const QJsonObject cache = QJsonDocument::fromJson(file.readAll()).object();
+    if (cache.value(QStringLiteral("version")).toInt() != CacheVersion)
+    {
+        return QJsonObject();
+    }
+
+    for (const auto& stamp : cache.value(QStringLiteral("files")).toArray())
+    {
+        if (!isUnchanged(stamp.toObject()))
+        {
+            qCDebug(KDEV_CARGO) << "Cache" << m_fileName << "is outdated by" << stamp.toObject().value(QStringLiteral("path")).toString();
+            return QJsonObject();
+        }
+    }
+
+    return cache.value(QStringLiteral("data")).toObject();
+}
+
+bool CargoCache::store(const QJsonObject& data, const QStringList& dependencies, Comparison comparison) const
+{
+    QJsonArray files;
+    for (const auto& dependency : dependencies)
+    {
+        const QFileInfo info(dependency);
+        QJsonObject stamp;
+        stamp.insert(QStringLiteral("path"), info.absoluteFilePath());
+        if (info.exists())
+        {
+            stamp.insert(QStringLiteral("size"), static_cast<double>(info.size()));
+            stamp.insert(QStringLiteral("mtime"), static_cast<double>(info.lastModified().toMSecsSinceEpoch()));
+            if (comparison == CompareContents)
+            {
+                stamp.insert(QStringLiteral("hash"), QString::fromLatin1(hashFile(dependency).toHex()));
+            }
+        }
+        files.append(stamp);
+    }
+
+    QJsonObject cache;
+    cache.insert(QStringLiteral("version"), CacheVersion);
+    cache.insert(QStringLiteral("files"), files);
+    cache.insert(QStringLiteral("data"), data);
+
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+
+    // Readers in other instances never see a partially written cache
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(KDEV_CARGO) << "Could not write cache" << m_fileName << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(cache).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
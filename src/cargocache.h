@@ -0,0 +1,72 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOCACHE_H
+#define CARGOCACHE_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+/**
+ * A JSON document cached on disk, together with the files it was computed from.
+ *
+ * Each file is recorded with its modification time and size, and optionally its content hash.
+ * Files whose time and size did not change are trusted without reading them,
+ * and hashed files that were only touched are recognized by their unchanged hash.
+ */
+class CargoCache
+{
+public:
+    /// How the files a cache depends on are compared when it is loaded
+    enum Comparison
+    {
+        /// By time and size, then by contents, for small files that are often saved without changes
+        CompareContents,
+        /// By time and size only, for large files like executables that would take long to hash
+        CompareTimestamps
+    };
+
+    explicit CargoCache(const QString& fileName);
+
+    QString fileName() const;
+
+    /**
+     * @return the cached data, or an empty object if there is none
+     *         or if any of the files it depends on has changed since it was stored
+     */
+    QJsonObject load() const;
+
+    /**
+     * Replaces the cached data with @p data, computed from @p dependencies.
+     * Dependencies that do not exist are recorded as such, so creating them invalidates the cache.
+     */
+    bool store(const QJsonObject& data, const QStringList& dependencies, Comparison comparison = CompareContents) const;
+
+    /// @return a hash of the contents of @p fileName, or an empty array if it cannot be read
+    static QByteArray hashFile(const QString& fileName);
+
+private:
+    QString m_fileName;
+};
+
+#endif
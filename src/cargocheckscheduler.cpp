@@ -0,0 +1,160 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargocheckscheduler.h"
+
+#include <KConfigGroup>
+
+#include <interfaces/icore.h>
+#include <interfaces/idocument.h>
+#include <interfaces/idocumentcontroller.h>
+#include <interfaces/iproject.h>
+#include <interfaces/iprojectcontroller.h>
+#include <interfaces/iruncontroller.h>
+#include <project/projectmodel.h>
+
+#include <QTimer>
+
+#include "cargobuildjob.h"
+#include "cargomanifest.h"
+#include "cargoplugin.h"
+#include "debug.h"
+
+using namespace KDevelop;
+
+CargoCheckScheduler::CargoCheckScheduler(CargoPlugin* plugin)
+    : QObject(plugin)
+    , m_plugin(plugin)
+{
+    connect(ICore::self()->documentController(), &IDocumentController::documentSaved,
+            this, &CargoCheckScheduler::documentSaved);
+    connect(ICore::self()->projectController(), &IProjectController::projectClosing,
+            this, &CargoCheckScheduler::projectClosing);
+}
+
+CargoCheckScheduler::~CargoCheckScheduler()
+{
+    for (const auto& check : m_checks)
+    {
+        if (check.job)
+        {
+            check.job->kill(KJob::Quietly);
+        }
+    }
+}
+
+void CargoCheckScheduler::documentSaved(IDocument* document)
+{
+    const QUrl url = document->url();
+    if (!url.isLocalFile() || !url.path().endsWith(QStringLiteral(".rs")))
+    {
+        return;
+    }
+
+    IProject* project = ICore::self()->projectController()->findProjectForUrl(url);
+    if (!project || project->buildSystemManager() != m_plugin)
+    {
+        return;
+    }
+
+    const KConfigGroup config(project->projectConfiguration(), "Cargo");
+    if (!config.readEntry("Check On Save", false))
+    {
+        return;
+    }
+
+    PendingCheck& check = m_checks[project];
+    const Path manifest = CargoManifest::findPackageManifest(Path(url), project->path());
+    if (manifest.isValid())
+    {
+        check.packages.insert(CargoManifest::packageName(manifest), manifest.parent());
+    }
+    else
+    {
+        check.workspace = true;
+    }
+
+    // Every save restarts the delay, so a series of saves results in a single check
+    if (!check.timer)
+    {
+        check.timer = new QTimer(this);
+        check.timer->setSingleShot(true);
+        connect(check.timer, &QTimer::timeout, this, [this, project]() {
+            startCheck(project);
+        });
+    }
+    check.timer->start(qMax(0, config.readEntry("Check Delay", 1000)));
+}
+
+void CargoCheckScheduler::projectClosing(IProject* project)
+{
+    auto it = m_checks.find(project);
+    if (it == m_checks.end())
+    {
+        return;
+    }
+
+    delete it->timer;
+    if (it->job)
+    {
+        it->job->kill(KJob::Quietly);
+    }
+    m_checks.erase(it);
+}
+
+void CargoCheckScheduler::startCheck(IProject* project)
+{
+    PendingCheck& check = m_checks[project];
+
+    // The running check has not seen the latest changes, so its results would be stale
+    if (check.job)
+    {
+        qCDebug(KDEV_CARGO) << "Killing outdated check of" << project->name();
+        check.job->kill(KJob::Quietly);
+    }
+
+    QStringList arguments;
+    Path scope = project->path();
+    if (check.workspace || check.packages.size() != 1)
+    {
+        arguments << QStringLiteral("--workspace");
+    }
+    else
+    {
+        arguments << QStringLiteral("-p") << check.packages.constBegin().key();
+
+        // Diagnostics in other packages are not reported by this check, so they must not be removed
+        scope = check.packages.constBegin().value();
+    }
+    check.packages.clear();
+    check.workspace = false;
+
+    auto job = new CargoBuildJob(m_plugin, project->projectItem(), QStringLiteral("check"));
+    job->setRunArguments(arguments);
+    job->setJsonDiagnostics(true);
+    job->setDiagnosticsScope(scope);
+    job->setLowPriority(true);
+    job->setVerbosity(OutputJob::Silent);
+
+    check.job = job;
+    ICore::self()->runController()->registerJob(job);
+}
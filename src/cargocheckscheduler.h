@@ -0,0 +1,75 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOCHECKSCHEDULER_H
+#define CARGOCHECKSCHEDULER_H
+
+#include <util/path.h>
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+
+class KJob;
+class QTimer;
+class CargoPlugin;
+
+namespace KDevelop
+{
+class IDocument;
+class IProject;
+}
+
+/**
+ * Runs `cargo check` in the background when Rust source files are saved,
+ * if enabled in the project configuration.
+ *
+ * Saves are collected for a configurable delay, then the packages that own the saved files are checked.
+ * A newer check of the same project kills the one that is still running,
+ * as its results would be outdated anyway.
+ */
+class CargoCheckScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CargoCheckScheduler(CargoPlugin* plugin);
+    ~CargoCheckScheduler() override;
+
+private:
+    struct PendingCheck
+    {
+        QTimer* timer = nullptr;
+        /// Directories of the packages to check, by package name
+        QHash<QString, KDevelop::Path> packages;
+        bool workspace = false;
+        QPointer<KJob> job;
+    };
+
+    void documentSaved(KDevelop::IDocument* document);
+    void projectClosing(KDevelop::IProject* project);
+    void startCheck(KDevelop::IProject* project);
+
+    CargoPlugin* m_plugin;
+    QHash<KDevelop::IProject*, PendingCheck> m_checks;
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargodepinfoindex.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "debug.h"
+
+CargoDepInfoIndex::CargoDepInfoIndex(const QString& workspaceRoot)
+ : m_workspaceRoot(workspaceRoot)
+{
+}
+
+QString CargoDepInfoIndex::depInfoFileName(const QString& executable)
+{
+    QString fileName = executable;
+    if (fileName.endsWith(QLatin1String(".exe")))
+    {
+        fileName.chop(4);
+    }
+    return fileName + QStringLiteral(".d");
+}
+
+QStringList CargoDepInfoIndex::parseDepInfo(const QByteArray& contents, const QString& workspaceRoot)
+{
+    QStringList sources;
+    QSet<QString> seen;
+    const QDir root(workspaceRoot);
+
+    for (const QByteArray& line : contents.split('\n'))
+    {
+        // Comments hold environment variables and other inputs that are not files
+        if (line.isEmpty() || line.startsWith('#'))
+        {
+            continue;
+        }
+
+        // Paths on Windows contain colons too, but never followed by a space
+        int separator = line.indexOf(": ");
+        if (separator == -1)
+        {
+            continue;
+        }
+
+        // Spaces in paths are escaped with a backslash
+        QString path;
+        auto addPath = [&path, &sources, &seen, &root]() {
+            if (!path.isEmpty())
+            {
+                const QString source = QDir::cleanPath(root.absoluteFilePath(path));
+                if (!seen.contains(source))
+                {
+                    seen.insert(source);
+                    sources << source;
+                }
+                path.clear();
+            }
+        };
+
+        const QString dependencies = QString::fromLocal8Bit(line.mid(separator + 2));
+        for (int i = 0; i < dependencies.size(); ++i)
+        {
+            const QChar c = dependencies.at(i);
+            if (c == QLatin1Char('\\') && i + 1 < dependencies.size() && dependencies.at(i + 1) == QLatin1Char(' '))
+            {
+                path += QLatin1Char(' ');
+                ++i;
+            }
+            else if (c == QLatin1Char(' ') || c == QLatin1Char('\r'))
+            {
+                addPath();
+            }
+            else
+            {
+                path += c;
+            }
+        }
+        addPath();
+    }
+
+    return sources;
+}
+
+void CargoDepInfoIndex::update(const QStringList& executables)
+{
+    const QStringList known = m_depInfo.keys();
+    for (const auto& executable : known)
+    {
+        if (!QFileInfo::exists(executable))
+        {
+            remove(executable);
+        }
+    }
+
+    for (const auto& executable : executables)
+    {
+        const QString fileName = depInfoFileName(executable);
+        const QDateTime modified = QFileInfo(fileName).lastModified();
+
+        auto it = m_depInfo.constFind(executable);
+        if (it != m_depInfo.constEnd() && it->modified == modified)
+        {
+            continue;
+        }
+        remove(executable);
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            qCDebug(KDEV_CARGO) << "No dep-info file for" << executable;
+            continue;
+        }
+
+        const QStringList sources = parseDepInfo(file.readAll(), m_workspaceRoot);
+        m_depInfo.insert(executable, { modified, sources });
+        for (const auto& source : sources)
+        {
+            m_executables[source].insert(executable);
+        }
+    }
+}
+
+void CargoDepInfoIndex::remove(const QString& executable)
+{
+    const DepInfo depInfo = m_depInfo.take(executable);
+    for (const auto& source : depInfo.sources)
+    {
+        auto it = m_executables.find(source);
+        if (it != m_executables.end())
+        {
+            it->remove(executable);
+            if (it->isEmpty())
+            {
+                m_executables.erase(it);
+            }
+        }
+    }
+}
+
+QStringList CargoDepInfoIndex::sources(const QString& executable) const
+{
+    return m_depInfo.value(executable).sources;
+}
+
+QStringList CargoDepInfoIndex::executables(const QString& sourceFile) const
+{
+    return m_executables.value(QDir::cleanPath(sourceFile)).toList();
+}
+
+QSet<QString> CargoDepInfoIndex::affectedExecutables(const QHash<QString, QDateTime>& lastPassed) const
+{
+    QSet<QString> affected;
+    for (auto it = lastPassed.constBegin(); it != lastPassed.constEnd(); ++it)
+    {
+        if (!it.value().isValid() || QFileInfo(it.key()).lastModified() > it.value())
+        {
+            affected.insert(it.key());
+        }
+    }
+
+    // Each source is looked at once, however many executables are compiled from it
+    for (auto it = m_executables.constBegin(); it != m_executables.constEnd(); ++it)
+    {
+        QDateTime modified;
+        for (const auto& executable : it.value())
+        {
+            if (affected.contains(executable) || !lastPassed.contains(executable))
+            {
+                continue;
+            }
+            if (!modified.isValid())
+            {
+                modified = QFileInfo(it.key()).lastModified();
+            }
+
+            // A source that was removed changed too
+            if (!modified.isValid() || modified > lastPassed.value(executable))
+            {
+                affected.insert(executable);
+            }
+        }
+    }
+
+    return affected;
+}
@@ -0,0 +1,84 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGODEPINFOINDEX_H
+#define CARGODEPINFOINDEX_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Maps source files to the test executables compiled from them.
+ *
+ * rustc writes a dep-info file next to every executable in target/<profile>/deps, which lists
+ * the source files of its crate as make rules. Paths of workspace members are relative to the
+ * workspace root. Dep-info files are only read again when they changed, so updating the index
+ * after each build is cheap.
+ *
+ * Sources of other crates the executable depends on are not listed, but changing them relinks the
+ * executable, so an executable that is newer than its last passing run counts as affected as well.
+ */
+class CargoDepInfoIndex
+{
+public:
+    /// @param workspaceRoot the directory relative paths in dep-info files are resolved against
+    explicit CargoDepInfoIndex(const QString& workspaceRoot);
+
+    /// Reads the dep-info files of @p executables that changed, and forgets executables that no longer exist
+    void update(const QStringList& executables);
+
+    /// @return the source files @p executable was compiled from
+    QStringList sources(const QString& executable) const;
+
+    /// @return the executables compiled from @p sourceFile
+    QStringList executables(const QString& sourceFile) const;
+
+    /**
+     * @return the executables among @p lastPassed whose sources or whose file changed since their time in @p lastPassed,
+     *         and those without a valid time, which never passed
+     */
+    QSet<QString> affectedExecutables(const QHash<QString, QDateTime>& lastPassed) const;
+
+    /// @return the dep-info file rustc writes for @p executable
+    static QString depInfoFileName(const QString& executable);
+
+    /// @return the dependencies of all rules in the dep-info file @p contents, with relative paths resolved against @p workspaceRoot
+    static QStringList parseDepInfo(const QByteArray& contents, const QString& workspaceRoot);
+
+private:
+    struct DepInfo
+    {
+        QDateTime modified;
+        QStringList sources;
+    };
+
+    void remove(const QString& executable);
+
+    QString m_workspaceRoot;
+    QHash<QString, DepInfo> m_depInfo;
+    QHash<QString, QSet<QString>> m_executables;
+};
+
+#endif
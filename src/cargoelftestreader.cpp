@@ -0,0 +1,899 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargoelftestreader.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QTextStream>
+#include <QVector>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "debug.h"
+
+using namespace KDevelop;
+
+namespace
+{
+
+enum
+{
+    ElfTypeDynamic = 3,
+    ElfMachineX86_64 = 62,
+    ElfMachineAArch64 = 183,
+
+    SectionSymbolTable = 2,
+    SectionRela = 4,
+    SectionNoBits = 8,
+    SectionRelr = 19,
+    SectionFlagAlloc = 0x2,
+    SectionFlagExecute = 0x4,
+
+    SymbolTypeFunction = 2,
+
+    RelocationX86_64Relative = 8,
+    RelocationAArch64Relative = 1027,
+
+    /// Test names longer than this are not looked for
+    MaxNameLength = 4096,
+    /// How many words of a test descriptor are looked at, enough for its name, source location and test function
+    DescriptorWords = 32,
+};
+
+struct Section
+{
+    quint32 type;
+    quint64 flags;
+    quint64 address;
+    quint64 offset;
+    quint64 size;
+    quint32 link;
+};
+
+/// A pointer in the executable that the dynamic loader relocates: the word at @c location will point to @c target
+struct Relocation
+{
+    quint64 location;
+    quint64 target;
+
+    bool operator<(const Relocation& other) const
+    {
+        return location < other.location;
+    }
+};
+
+class ElfImage
+{
+public:
+    ElfImage(const uchar* data, quint64 size)
+     : m_data(data)
+     , m_size(size)
+    {
+    }
+
+    bool contains(quint64 offset, quint64 length) const
+    {
+        return offset <= m_size && length <= m_size - offset;
+    }
+
+    template<typename T>
+    T read(quint64 offset) const
+    {
+        return qFromLittleEndian<T>(m_data + offset);
+    }
+
+    const char* chars(quint64 offset) const
+    {
+        return reinterpret_cast<const char*>(m_data + offset);
+    }
+
+    /// Maps a virtual address to a file offset, @return false if it is not backed by the file
+    bool offsetOf(quint64 address, quint64 length, quint64* offset) const
+    {
+        for (const Section& section : sections)
+        {
+            if ((section.flags & SectionFlagAlloc) && section.type != SectionNoBits
+                && address >= section.address && address - section.address <= section.size
+                && length <= section.size - (address - section.address))
+            {
+                *offset = section.offset + (address - section.address);
+                return contains(*offset, length);
+            }
+        }
+        return false;
+    }
+
+    /// Reads a 64-bit word at a virtual address
+    bool word(quint64 address, quint64* value) const
+    {
+        quint64 offset;
+        if (!offsetOf(address, 8, &offset))
+        {
+            return false;
+        }
+        *value = read<quint64>(offset);
+        return true;
+    }
+
+    /// @return whether @p address is in code
+    bool isExecutable(quint64 address) const
+    {
+        for (const Section& section : sections)
+        {
+            if ((section.flags & SectionFlagExecute) && address >= section.address && address - section.address < section.size)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Reads the &str whose pointer is relocated at @p relocation, and whose length follows the pointer
+    QByteArray stringSlice(const Relocation& relocation) const
+    {
+        quint64 length;
+        quint64 offset;
+        if (!word(relocation.location + 8, &length) || length == 0 || length >= MaxNameLength
+            || !offsetOf(relocation.target, length, &offset))
+        {
+            return QByteArray();
+        }
+        return QByteArray::fromRawData(chars(offset), length);
+    }
+
+    QVector<Section> sections;
+
+private:
+    const uchar* m_data;
+    quint64 m_size;
+};
+
+/**
+ * Demangles a legacy Rust symbol name into its path without the crate and the hash,
+ * for example "_ZN15kdev_cargo_test5tests6passes17h0123456789abcdefE" into "tests::passes".
+ *
+ * Test functions are named after the test, but the closure libtest calls them through may be the only symbol left,
+ * so a trailing closure is dropped as well. Other paths containing escaped characters are never test names.
+ */
+QByteArray testPath(const char* symbol, const char* end)
+{
+    if (end - symbol < 4 || qstrncmp(symbol, "_ZN", 3) != 0)
+    {
+        return QByteArray();
+    }
+
+    QVector<QByteArray> segments;
+    const char* p = symbol + 3;
+    while (p < end && *p != 'E')
+    {
+        int length = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            length = length * 10 + (*p - '0');
+            ++p;
+            if (length > MaxNameLength)
+            {
+                return QByteArray();
+            }
+        }
+        if (length == 0 || end - p < length)
+        {
+            return QByteArray();
+        }
+        segments << QByteArray::fromRawData(p, length);
+        p += length;
+    }
+
+    auto isHash = [](const QByteArray& segment) {
+        if (segment.size() != 17 || segment.at(0) != 'h')
+        {
+            return false;
+        }
+        for (int i = 1; i < segment.size(); ++i)
+        {
+            if (!isxdigit(static_cast<uchar>(segment.at(i))))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (!segments.isEmpty() && isHash(segments.last()))
+    {
+        segments.removeLast();
+    }
+    if (!segments.isEmpty() && segments.last() == "_$u7b$$u7b$closure$u7d$$u7d$")
+    {
+        segments.removeLast();
+    }
+    if (segments.size() < 2)
+    {
+        return QByteArray();
+    }
+
+    QByteArray path;
+    for (int i = 1; i < segments.size(); ++i)
+    {
+        if (segments.at(i).contains('$'))
+        {
+            return QByteArray();
+        }
+        if (i > 1)
+        {
+            path += "::";
+        }
+        path += segments.at(i);
+    }
+    return path;
+}
+
+QSet<QByteArray> candidateNames(const ElfImage& image)
+{
+    QSet<QByteArray> names;
+    for (const Section& symbols : image.sections)
+    {
+        if (symbols.type != SectionSymbolTable || symbols.link >= quint32(image.sections.size()))
+        {
+            continue;
+        }
+        const Section& strings = image.sections.at(symbols.link);
+        if (!image.contains(symbols.offset, symbols.size) || !image.contains(strings.offset, strings.size))
+        {
+            continue;
+        }
+
+        const char* stringsEnd = image.chars(strings.offset + strings.size);
+        for (quint64 entry = symbols.offset; entry + 24 <= symbols.offset + symbols.size; entry += 24)
+        {
+            const quint32 name = image.read<quint32>(entry);
+            const quint8 info = image.read<quint8>(entry + 4);
+            if ((info & 0xf) != SymbolTypeFunction || name >= strings.size)
+            {
+                continue;
+            }
+
+            const char* symbol = image.chars(strings.offset + name);
+            const char* end = static_cast<const char*>(memchr(symbol, 0, stringsEnd - symbol));
+            const QByteArray path = testPath(symbol, end ? end : stringsEnd);
+            if (!path.isEmpty())
+            {
+                // The symbol table is unmapped along with the file, so the path has to be copied
+                names.insert(QByteArray(path.constData(), path.size()));
+            }
+        }
+    }
+    return names;
+}
+
+QVector<Relocation> relativeRelocations(const ElfImage& image, quint32 relativeType)
+{
+    QVector<Relocation> relocations;
+    for (const Section& section : image.sections)
+    {
+        if (!image.contains(section.offset, section.size))
+        {
+            continue;
+        }
+
+        if (section.type == SectionRela)
+        {
+            for (quint64 entry = section.offset; entry + 24 <= section.offset + section.size; entry += 24)
+            {
+                if ((image.read<quint64>(entry + 8) & 0xffffffff) == relativeType)
+                {
+                    relocations << Relocation{image.read<quint64>(entry), image.read<quint64>(entry + 16)};
+                }
+            }
+        }
+        else if (section.type == SectionRelr)
+        {
+            /*
+             * Packed relative relocations keep the addend in place. Even entries are addresses,
+             * odd entries are bitmaps of the 63 words following the last address.
+             */
+            quint64 next = 0;
+            for (quint64 entry = section.offset; entry + 8 <= section.offset + section.size; entry += 8)
+            {
+                const quint64 value = image.read<quint64>(entry);
+                QVector<quint64> locations;
+                if ((value & 1) == 0)
+                {
+                    locations << value;
+                    next = value + 8;
+                }
+                else
+                {
+                    for (int bit = 1; bit < 64; ++bit)
+                    {
+                        if (value & (quint64(1) << bit))
+                        {
+                            locations << next + (bit - 1) * 8;
+                        }
+                    }
+                    next += 63 * 8;
+                }
+
+                for (quint64 location : locations)
+                {
+                    quint64 target;
+                    if (image.word(location, &target))
+                    {
+                        relocations << Relocation{location, target};
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort(relocations.begin(), relocations.end());
+    return relocations;
+}
+
+/// @return the relocation at @p location, or null if the word there is not relocated
+const Relocation* relocationAt(const QVector<Relocation>& relocations, quint64 location)
+{
+    auto it = std::lower_bound(relocations.constBegin(), relocations.constEnd(), Relocation{location, 0});
+    return it != relocations.constEnd() && it->location == location ? it : nullptr;
+}
+
+/// Whether @p name is a path of identifiers, like every test name
+bool isTestPath(const QByteArray& name)
+{
+    int start = 0;
+    while (true)
+    {
+        const int end = name.indexOf("::", start);
+        const QByteArray segment = name.mid(start, end == -1 ? -1 : end - start);
+        if (segment.isEmpty() || isdigit(static_cast<uchar>(segment.at(0))))
+        {
+            return false;
+        }
+        for (char c : segment)
+        {
+            if (!isalnum(static_cast<uchar>(c)) && c != '_')
+            {
+                return false;
+            }
+        }
+        if (end == -1)
+        {
+            return true;
+        }
+        start = end + 2;
+    }
+}
+
+/**
+ * Where a test descriptor, a TestDescAndFn, keeps the relocated pointers libtest needs.
+ *
+ * The layout of the struct depends on the toolchain, but all descriptors in an executable share it.
+ */
+struct DescriptorLayout
+{
+    quint64 name;
+    quint64 source;
+    quint64 function;
+};
+
+/// What a relocated word in a test descriptor points to
+enum DescriptorSlot
+{
+    StringSlot,
+    SourceSlot,
+    FunctionSlot
+};
+
+/// @return the relocated words of the descriptor at @p descriptor that can be part of its layout, by their offset
+QMap<quint64, DescriptorSlot> descriptorSlots(const ElfImage& image, const QVector<Relocation>& relocations, quint64 descriptor)
+{
+    QMap<quint64, DescriptorSlot> words;
+    auto it = std::lower_bound(relocations.constBegin(), relocations.constEnd(), Relocation{descriptor, 0});
+    for (; it != relocations.constEnd() && it->location < descriptor + DescriptorWords * 8; ++it)
+    {
+        if (image.isExecutable(it->target))
+        {
+            words.insert(it->location - descriptor, FunctionSlot);
+            continue;
+        }
+        const QByteArray string = image.stringSlice(*it);
+        if (!string.isEmpty())
+        {
+            words.insert(it->location - descriptor, string.endsWith(".rs") ? SourceSlot : StringSlot);
+        }
+    }
+    return words;
+}
+
+/// @return the name of the test whose descriptor is at @p descriptor, or an empty array if there is none
+QByteArray descriptorName(const ElfImage& image, const QVector<Relocation>& relocations, quint64 descriptor, const DescriptorLayout& layout)
+{
+    const Relocation* name = relocationAt(relocations, descriptor + layout.name);
+    const Relocation* source = relocationAt(relocations, descriptor + layout.source);
+    const Relocation* function = relocationAt(relocations, descriptor + layout.function);
+    if (!name || !source || !function || !image.isExecutable(function->target) || !image.stringSlice(*source).endsWith(".rs"))
+    {
+        return QByteArray();
+    }
+
+    const QByteArray test = image.stringSlice(*name);
+    return isTestPath(test) ? test : QByteArray();
+}
+
+/**
+ * Finds the test array, which the generated main function passes to test_main_static.
+ *
+ * It is a run of relocated pointers to descriptors that all have a name, a source file and a test function
+ * at the same offsets, the lowest ones if there are several, as the name comes before other strings like the ignore message.
+ * Exactly one such array has to exist, and its descriptors have to be the only ones with that layout,
+ * otherwise the executable is not understood.
+ */
+bool findTestArray(const ElfImage& image, const QVector<Relocation>& relocations, QVector<quint64>* descriptors, DescriptorLayout* layout)
+{
+    QVector<QVector<quint64>> runs;
+    quint64 runEnd = 0;
+    for (const Relocation& relocation : relocations)
+    {
+        const QList<DescriptorSlot> kinds = descriptorSlots(image, relocations, relocation.target).values();
+        if (!kinds.contains(StringSlot) || !kinds.contains(SourceSlot) || !kinds.contains(FunctionSlot))
+        {
+            continue;
+        }
+        if (runs.isEmpty() || relocation.location != runEnd)
+        {
+            runs << QVector<quint64>();
+        }
+        runs.last() << relocation.target;
+        runEnd = relocation.location + 8;
+    }
+
+    bool found = false;
+    for (const QVector<quint64>& run : runs)
+    {
+        QSet<quint64> offsets[3];
+        for (int i = 0; i < run.size(); ++i)
+        {
+            QSet<quint64> descriptorOffsets[3];
+            const QMap<quint64, DescriptorSlot> words = descriptorSlots(image, relocations, run.at(i));
+            for (auto it = words.constBegin(); it != words.constEnd(); ++it)
+            {
+                descriptorOffsets[it.value()].insert(it.key());
+            }
+            for (int slot = 0; slot < 3; ++slot)
+            {
+                if (i == 0)
+                {
+                    offsets[slot] = descriptorOffsets[slot];
+                }
+                else
+                {
+                    offsets[slot].intersect(descriptorOffsets[slot]);
+                }
+            }
+        }
+        if (offsets[StringSlot].isEmpty() || offsets[SourceSlot].isEmpty() || offsets[FunctionSlot].isEmpty())
+        {
+            continue;
+        }
+
+        const DescriptorLayout runLayout{
+            *std::min_element(offsets[StringSlot].constBegin(), offsets[StringSlot].constEnd()),
+            *std::min_element(offsets[SourceSlot].constBegin(), offsets[SourceSlot].constEnd()),
+            *std::min_element(offsets[FunctionSlot].constBegin(), offsets[FunctionSlot].constEnd())
+        };
+        QSet<QByteArray> names;
+        for (quint64 descriptor : run)
+        {
+            names.insert(descriptorName(image, relocations, descriptor, runLayout));
+        }
+        if (names.contains(QByteArray()) || names.size() != run.size())
+        {
+            continue;
+        }
+
+        if (found)
+        {
+            qCDebug(KDEV_CARGO) << "More than one array of test descriptors";
+            return false;
+        }
+        found = true;
+        *descriptors = run;
+        *layout = runLayout;
+    }
+    if (!found)
+    {
+        return false;
+    }
+
+    // Tests left out of the array would not be run, so the array is not the one libtest gets
+    QSet<quint64> laidOut;
+    for (const Relocation& relocation : relocations)
+    {
+        const quint64 descriptor = relocation.location - layout->name;
+        if (relocation.location >= layout->name && !descriptorName(image, relocations, descriptor, *layout).isEmpty())
+        {
+            laidOut.insert(descriptor);
+        }
+    }
+    const QSet<quint64> listed = QSet<quint64>::fromList(descriptors->toList());
+    if (laidOut != listed)
+    {
+        qCDebug(KDEV_CARGO) << "The test array lists" << listed.size() << "of" << laidOut.size() << "test descriptors";
+        return false;
+    }
+    return true;
+}
+
+/// A test found in the executable, with the location of its descriptor
+struct FoundTest
+{
+    QString name;
+    quint64 descriptor;
+};
+
+/**
+ * Decides which tests are ignored from their source code.
+ *
+ * Test descriptors contain the source file and the line of the test function,
+ * but their layout depends on the toolchain. The line is found as the descriptor word
+ * pointing to a line that declares the test function, in the same place for all tests.
+ */
+class IgnoredTestFinder
+{
+public:
+    IgnoredTestFinder(const ElfImage& image, const QVector<Relocation>& relocations, const DescriptorLayout& layout,
+                      const Path& sourceRoot, const QDateTime& built)
+     : m_image(image)
+     , m_relocations(relocations)
+     , m_layout(layout)
+     , m_sourceRoot(sourceRoot)
+     , m_built(built)
+    {
+    }
+
+    bool find(const QVector<FoundTest>& tests, QStringList* ignored)
+    {
+        QVector<QStringList> testSources;
+        QVector<QVector<quint64>> testWords;
+        QSet<int> lineWords;
+        for (int i = 0; i < DescriptorWords; ++i)
+        {
+            lineWords.insert(i);
+        }
+
+        for (const FoundTest& test : tests)
+        {
+            const QStringList* lines = sourceOf(test.descriptor);
+            if (!lines)
+            {
+                return false;
+            }
+
+            const QString function = QStringLiteral("fn ") + test.name.mid(test.name.lastIndexOf(QLatin1Char(':')) + 1);
+            QVector<quint64> words(DescriptorWords, 0);
+            QSet<int> matching;
+            for (int i = 0; i < DescriptorWords; ++i)
+            {
+                m_image.word(test.descriptor + i * 8, &words[i]);
+                if (words[i] > 0 && words[i] <= quint64(lines->size()) && declares(lines->at(words[i] - 1), function))
+                {
+                    matching.insert(i);
+                }
+            }
+
+            lineWords.intersect(matching);
+            if (lineWords.isEmpty())
+            {
+                return false;
+            }
+            testSources << *lines;
+            testWords << words;
+        }
+
+        const int lineWord = *std::min_element(lineWords.constBegin(), lineWords.constEnd());
+        for (int i = 0; i < tests.size(); ++i)
+        {
+            bool isIgnored;
+            if (!attributesIgnore(testSources.at(i), testWords.at(i).at(lineWord) - 1, &isIgnored))
+            {
+                return false;
+            }
+            if (isIgnored)
+            {
+                *ignored << tests.at(i).name;
+            }
+        }
+        return agreesWithDescriptors(tests, *ignored);
+    }
+
+private:
+    static bool declares(const QString& line, const QString& function)
+    {
+        int index = line.indexOf(function);
+        while (index != -1)
+        {
+            const int end = index + function.size();
+            if (end == line.size() || !(line.at(end).isLetterOrNumber() || line.at(end) == QLatin1Char('_')))
+            {
+                return true;
+            }
+            index = line.indexOf(function, end);
+        }
+        return false;
+    }
+
+    /**
+     * Looks for #[ignore] in the attributes above the test function declared on @p line.
+     *
+     * @return false if the attributes mention ignoring in some other way, such as cfg_attr(..., ignore)
+     */
+    static bool attributesIgnore(const QStringList& lines, int line, bool* isIgnored)
+    {
+        *isIgnored = false;
+        for (int i = line - 1; i >= 0; --i)
+        {
+            const QString text = lines.at(i).trimmed();
+            if (text.endsWith(QLatin1Char('{')) || text.endsWith(QLatin1Char('}')) || text.endsWith(QLatin1Char(';')))
+            {
+                break;
+            }
+            if (text.startsWith(QLatin1String("//")) || !text.contains(QLatin1String("ignore")))
+            {
+                continue;
+            }
+
+            if (text == QLatin1String("#[ignore]") || text.startsWith(QLatin1String("#[ignore =")) || text.startsWith(QLatin1String("#[ignore(")))
+            {
+                *isIgnored = true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const QStringList* sourceOf(quint64 descriptor)
+    {
+        const Relocation* source = relocationAt(m_relocations, descriptor + m_layout.source);
+        return source ? sourceLines(QString::fromUtf8(m_image.stringSlice(*source))) : nullptr;
+    }
+
+    /**
+     * Descriptors have a flag for ignored tests, at an offset that depends on the toolchain,
+     * so the attributes are only trusted if there is a byte that is set exactly for the tests they ignore.
+     *
+     * Unless some tests are ignored and some are not, any byte with the same value in all descriptors
+     * would agree, so the flag cannot be told apart from padding and the attributes are not trusted.
+     */
+    bool agreesWithDescriptors(const QVector<FoundTest>& tests, const QStringList& ignored) const
+    {
+        const QSet<QString> ignoredNames = QSet<QString>::fromList(ignored);
+        if (ignoredNames.isEmpty() || ignoredNames.size() == tests.size())
+        {
+            return false;
+        }
+
+        for (quint64 offset = 0; offset < DescriptorWords * 8; ++offset)
+        {
+            bool agrees = true;
+            for (const FoundTest& test : tests)
+            {
+                quint64 fileOffset;
+                if (!m_image.offsetOf(test.descriptor + offset, 1, &fileOffset)
+                    || m_image.read<quint8>(fileOffset) != (ignoredNames.contains(test.name) ? 1 : 0))
+                {
+                    agrees = false;
+                    break;
+                }
+            }
+            if (agrees)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const QStringList* sourceLines(const QString& fileName)
+    {
+        auto it = m_sources.constFind(fileName);
+        if (it == m_sources.constEnd())
+        {
+            QStringList lines;
+            // Sources of dependencies outside of the workspace have absolute paths
+            QFile file(QDir::isAbsolutePath(fileName) ? fileName : Path(m_sourceRoot, fileName).toLocalFile());
+
+            // A source file changed since the build may no longer have the test at the same line
+            if (QFileInfo(file).lastModified() <= m_built && file.open(QIODevice::ReadOnly | QIODevice::Text))
+            {
+                QTextStream stream(&file);
+                stream.setCodec("UTF-8");
+                while (!stream.atEnd())
+                {
+                    lines << stream.readLine();
+                }
+            }
+            it = m_sources.insert(fileName, lines);
+        }
+        return it->isEmpty() ? nullptr : &it.value();
+    }
+
+    const ElfImage& m_image;
+    const QVector<Relocation>& m_relocations;
+    DescriptorLayout m_layout;
+    Path m_sourceRoot;
+    QDateTime m_built;
+    QHash<QString, QStringList> m_sources;
+};
+
+}
+
+CargoElfTestReader::CargoElfTestReader(const QString& executable)
+ : m_executable(executable)
+ , m_ignoredCasesKnown(false)
+{
+}
+
+bool CargoElfTestReader::read(const Path& sourceRoot)
+{
+    m_cases.clear();
+    m_ignoredCases.clear();
+    m_ignoredCasesKnown = false;
+
+    QFile file(m_executable);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < 64)
+    {
+        return false;
+    }
+
+    const quint64 size = file.size();
+    const uchar* data = file.map(0, size);
+    if (!data)
+    {
+        return false;
+    }
+    ElfImage image(data, size);
+
+    // Only 64-bit little-endian position independent executables are supported
+    if (qstrncmp(image.chars(0), "\x7f" "ELF", 4) != 0 || data[4] != 2 || data[5] != 1
+        || image.read<quint16>(0x10) != ElfTypeDynamic)
+    {
+        return false;
+    }
+
+    quint32 relativeType;
+    switch (image.read<quint16>(0x12))
+    {
+    case ElfMachineX86_64:
+        relativeType = RelocationX86_64Relative;
+        break;
+    case ElfMachineAArch64:
+        relativeType = RelocationAArch64Relative;
+        break;
+    default:
+        return false;
+    }
+
+    const quint64 sectionsOffset = image.read<quint64>(0x28);
+    const quint16 sectionSize = image.read<quint16>(0x3a);
+    const quint16 sectionCount = image.read<quint16>(0x3c);
+    if (sectionSize < 0x40 || !image.contains(sectionsOffset, quint64(sectionSize) * sectionCount))
+    {
+        return false;
+    }
+    for (quint16 i = 0; i < sectionCount; ++i)
+    {
+        const quint64 header = sectionsOffset + quint64(i) * sectionSize;
+        image.sections << Section{
+            image.read<quint32>(header + 0x04),
+            image.read<quint64>(header + 0x08),
+            image.read<quint64>(header + 0x10),
+            image.read<quint64>(header + 0x18),
+            image.read<quint64>(header + 0x20),
+            image.read<quint32>(header + 0x28)
+        };
+    }
+
+    const QSet<QByteArray> candidates = candidateNames(image);
+    if (candidates.isEmpty())
+    {
+        // A stripped executable, whose test array cannot be checked against anything
+        return false;
+    }
+
+    const QVector<Relocation> relocations = relativeRelocations(image, relativeType);
+    QVector<quint64> descriptors;
+    DescriptorLayout layout;
+    if (!findTestArray(image, relocations, &descriptors, &layout))
+    {
+        // Either there are no tests, or they are laid out differently, so the executable is asked
+        return false;
+    }
+
+    QVector<FoundTest> tests;
+    QSet<QByteArray> names;
+    for (quint64 descriptor : descriptors)
+    {
+        const QByteArray name = descriptorName(image, relocations, descriptor, layout);
+        names.insert(name);
+        tests << FoundTest{QString::fromUtf8(name), descriptor};
+    }
+
+    /*
+     * Test functions that were not inlined or folded have a symbol named after the test, and the name is also a string.
+     * Such a test missing from the array means the array is not the one libtest gets.
+     */
+    for (const Relocation& relocation : relocations)
+    {
+        const QByteArray name = image.stringSlice(relocation);
+        if (!name.isEmpty() && candidates.contains(name) && !names.contains(name))
+        {
+            qCDebug(KDEV_CARGO) << "Test" << name << "is not in the test array of" << m_executable;
+            return false;
+        }
+    }
+
+    std::sort(tests.begin(), tests.end(), [](const FoundTest& a, const FoundTest& b) {
+        return a.name < b.name;
+    });
+    for (const FoundTest& test : tests)
+    {
+        m_cases << test.name;
+    }
+
+    IgnoredTestFinder ignoredFinder(image, relocations, layout, sourceRoot, QFileInfo(file).lastModified());
+    m_ignoredCasesKnown = ignoredFinder.find(tests, &m_ignoredCases);
+    if (!m_ignoredCasesKnown)
+    {
+        m_ignoredCases.clear();
+    }
+
+    qCDebug(KDEV_CARGO) << "Read" << m_cases.size() << "test cases from" << m_executable
+                        << "ignored ones known:" << m_ignoredCasesKnown;
+    return true;
+}
+
+QStringList CargoElfTestReader::cases() const
+{
+    return m_cases;
+}
+
+bool CargoElfTestReader::ignoredCasesKnown() const
+{
+    return m_ignoredCasesKnown;
+}
+
+QStringList CargoElfTestReader::ignoredCases() const
+{
+    return m_ignoredCases;
+}
@@ -0,0 +1,71 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOELFTESTREADER_H
+#define CARGOELFTESTREADER_H
+
+#include <util/path.h>
+
+#include <QStringList>
+
+/**
+ * Finds the test cases of a libtest test executable without running it.
+ *
+ * The executable is memory-mapped, and tests are taken from the array of test descriptors
+ * that the generated main function passes to libtest. The layout of a descriptor depends on the toolchain,
+ * so it is accepted only if all descriptors have their name, source file and test function at the same offsets,
+ * the array lists every descriptor with that layout, and every test function left in the symbol table is in it.
+ *
+ * Whether a test is ignored is read from the #[ignore] attribute in the source file named by the descriptor,
+ * and is only known if the descriptors have a flag that agrees with it.
+ *
+ * Only position independent 64-bit little-endian ELF executables with legacy symbol mangling are supported,
+ * which is what cargo produces on Linux by default.
+ */
+class CargoElfTestReader
+{
+public:
+    explicit CargoElfTestReader(const QString& executable);
+
+    /**
+     * Reads the test cases.
+     *
+     * @param sourceRoot the directory relative source file names in the executable are relative to,
+     *                   the workspace root for executables built by cargo
+     * @return false if the executable could not be decoded with confidence, and has to be listed by running it
+     */
+    bool read(const KDevelop::Path& sourceRoot);
+
+    QStringList cases() const;
+
+    /// @return whether ignoredCases() is known, otherwise it has to be listed by running the executable
+    bool ignoredCasesKnown() const;
+    QStringList ignoredCases() const;
+
+private:
+    QString m_executable;
+    QStringList m_cases;
+    QStringList m_ignoredCases;
+    bool m_ignoredCasesKnown;
+};
+
+#endif
@@ -0,0 +1,283 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargofilterstrategy.h"
+
+#include <QMutexLocker>
+
+using namespace KDevelop;
+
+namespace
+{
+
+/// Returns the next run of non-space characters in @p line, starting the search at @p from
+QStringRef nextToken(const QString& line, int from)
+{
+    const int length = line.size();
+    int start = from;
+    while (start < length && line.at(start) == QLatin1Char(' '))
+    {
+        ++start;
+    }
+    int end = start;
+    while (end < length && line.at(end) != QLatin1Char(' '))
+    {
+        ++end;
+    }
+    return line.midRef(start, end - start);
+}
+
+/// Splits a trailing ":<number>" off @p text, leaving @p text untouched if there is none
+bool takeNumberSuffix(QStringRef* text, int* number)
+{
+    int colon = text->size() - 1;
+    while (colon >= 0 && text->at(colon) != QLatin1Char(':'))
+    {
+        --colon;
+    }
+    if (colon < 0)
+    {
+        return false;
+    }
+
+    bool ok = false;
+    const int value = text->mid(colon + 1).toInt(&ok);
+    if (!ok)
+    {
+        return false;
+    }
+
+    *number = value;
+    *text = text->left(colon);
+    return true;
+}
+
+/// Compares @p a and @p b without trailing whitespace, such as the carriage returns of Windows line endings
+bool sameLine(const QString& a, const QString& b)
+{
+    int aLength = a.size();
+    while (aLength > 0 && a.at(aLength - 1).isSpace())
+    {
+        --aLength;
+    }
+    int bLength = b.size();
+    while (bLength > 0 && b.at(bLength - 1).isSpace())
+    {
+        --bLength;
+    }
+    return aLength == bLength && a.midRef(0, aLength) == b.midRef(0, bLength);
+}
+
+}
+
+void CargoClassifiedItems::enqueue(const QVector<FilteredItem>& items)
+{
+    if (items.isEmpty())
+    {
+        return;
+    }
+
+    QMutexLocker lock(&m_mutex);
+    for (const auto& item : items)
+    {
+        m_items.enqueue(item);
+    }
+}
+
+bool CargoClassifiedItems::takeMatching(const QString& line, FilteredItem* item)
+{
+    QMutexLocker lock(&m_mutex);
+    const int lookahead = qMin<int>(m_items.size(), MaxLookahead);
+    for (int i = 0; i < lookahead; ++i)
+    {
+        if (sameLine(m_items.at(i).originalLine, line))
+        {
+            // Otherwise a single line the model never shows would keep every later item from matching
+            m_items.erase(m_items.begin(), m_items.begin() + i);
+            *item = m_items.dequeue();
+            return true;
+        }
+    }
+    return false;
+}
+
+int CargoClassifiedItems::size()
+{
+    QMutexLocker lock(&m_mutex);
+    return m_items.size();
+}
+
+CargoFilterStrategy::CargoFilterStrategy(const QUrl& buildDir, const QSharedPointer<CargoClassifiedItems>& classifiedItems)
+ : buildDir(buildDir)
+ , classifiedItems(classifiedItems)
+ , currentItemType(FilteredItem::StandardItem)
+{
+}
+
+CargoFilterStrategy::~CargoFilterStrategy()
+{
+}
+
+KDevelop::FilteredItem CargoFilterStrategy::errorInLine(const QString& line)
+{
+    /*
+     * This is called for every line of build output, so it avoids allocating:
+     * tokens are references into the line, and resolved file URLs are cached.
+     */
+    KDevelop::FilteredItem item(line);
+    if (classifiedItems && classifiedItems->takeMatching(line, &item))
+    {
+        /*
+         * The item comes from a JSON message and already points to the exact span,
+         * so we only remember the file for the gutter lines that may follow.
+         */
+        if (item.url.isValid())
+        {
+            currentFile = item.url.toLocalFile();
+            currentUrl = item.url;
+        }
+        currentItemType = item.type;
+        return item;
+    }
+
+    if (line.startsWith(QLatin1String("error:")) || line.startsWith(QLatin1String("error[")))
+    {
+        item.type = FilteredItem::ErrorItem;
+    }
+    else if (line.startsWith(QLatin1String("warning:")) || line.startsWith(QLatin1String("warning[")))
+    {
+        item.type = FilteredItem::WarningItem;
+    }
+    else if (line.startsWith(QLatin1String("   Compiling"))
+            || line.startsWith(QLatin1String("    Finished")))
+    {
+        item.type = FilteredItem::ActionItem;
+    }
+    else
+    {
+        const QStringRef first = nextToken(line, 0);
+        const QStringRef second = nextToken(line, first.position() + first.size());
+
+        if (first == QLatin1String("-->") && !second.isEmpty())
+        {
+            item.type = currentItemType;
+
+            // The location is file:line:column, and the file name may itself contain spaces
+            QStringRef file = line.midRef(second.position()).trimmed();
+            int lineNo = -1;
+            int columnNo = -1;
+            if (takeNumberSuffix(&file, &columnNo))
+            {
+                if (!takeNumberSuffix(&file, &lineNo))
+                {
+                    lineNo = columnNo;
+                    columnNo = -1;
+                }
+            }
+
+            item.isActivatable = true;
+            item.url = urlForFile(file);
+
+            /*
+             * Cargo counts lines from 1, and so does Kate,
+             * but KDevelop internally counts from 0,
+             * so we have to decrement the line number by 1.
+             * The same is true for column numbers.
+             */
+            if (lineNo > 0)
+            {
+                item.lineNo = lineNo - 1;
+            }
+            if (columnNo > 0)
+            {
+                item.columnNo = columnNo - 1;
+            }
+        }
+        else if (first.size() == 1 && (first.at(0) == QLatin1Char('|') || first.at(0) == QLatin1Char('=')))
+        {
+            item.type = FilteredItem::InformationItem;
+        }
+        else if (second.size() == 1 && second.at(0) == QLatin1Char('|'))
+        {
+            bool ok = false;
+            const int lineNo = first.toInt(&ok);
+
+            item.type = FilteredItem::InformationItem;
+            if (ok && !currentUrl.isEmpty())
+            {
+                item.isActivatable = true;
+                item.url = currentUrl;
+                item.lineNo = lineNo - 1;
+
+                /*
+                 * We determine the column number from the line itself,
+                 * as the first non-space character of the source code,
+                 * which starts after the line number and "| ".
+                 */
+                const int idx = second.position() + 2;
+                const int length = line.size();
+
+                item.columnNo = 0;
+                for (int i = idx; i < length; ++i)
+                {
+                    if (!line.at(i).isSpace())
+                    {
+                        item.columnNo = i - idx;
+                        break;
+                    }
+                }
+            }
+        }
+        else
+        {
+            item.type = FilteredItem::StandardItem;
+        }
+    }
+    currentItemType = item.type;
+    return item;
+}
+
+QUrl CargoFilterStrategy::urlForFile(const QStringRef& fileName)
+{
+    if (!currentUrl.isEmpty() && fileName == currentFile)
+    {
+        return currentUrl;
+    }
+
+    currentFile = fileName.toString();
+    auto it = urlCache.constFind(currentFile);
+    if (it == urlCache.constEnd())
+    {
+        if (urlCache.size() >= MaxCachedUrls)
+        {
+            urlCache.clear();
+        }
+        it = urlCache.insert(currentFile, Path(buildDir, currentFile).toUrl());
+    }
+    currentUrl = it.value();
+    return currentUrl;
+}
+
+KDevelop::FilteredItem CargoFilterStrategy::actionInLine(const QString& line)
+{
+    return KDevelop::FilteredItem(line);
+}
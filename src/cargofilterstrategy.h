@@ -0,0 +1,89 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOFILTERSTRATEGY_H
+#define CARGOFILTERSTRATEGY_H
+
+#include <outputview/filtereditem.h>
+#include <outputview/ifilterstrategy.h>
+#include <util/path.h>
+
+#include <QHash>
+#include <QMutex>
+#include <QQueue>
+#include <QSharedPointer>
+
+/**
+ * Output items that were already classified from cargo's JSON messages,
+ * waiting for the output model to reach their lines.
+ *
+ * The build job adds items here right before appending their lines to the model,
+ * while the filter strategy takes them out from the model's worker thread.
+ */
+class CargoClassifiedItems
+{
+public:
+    void enqueue(const QVector<KDevelop::FilteredItem>& items);
+
+    /**
+     * Takes the oldest queued item that belongs to @p line, among the first MaxLookahead items.
+     * Items queued before it are stale, such as items whose lines never reached the model, and are dropped.
+     * Lines are compared without trailing whitespace.
+     *
+     * @return true if @p item was set, false if @p line has to be classified some other way
+     */
+    bool takeMatching(const QString& line, KDevelop::FilteredItem* item);
+
+    int size();
+
+private:
+    /// Plain lines never match, so they are only compared with this many items
+    enum { MaxLookahead = 64 };
+
+    QMutex m_mutex;
+    QQueue<KDevelop::FilteredItem> m_items;
+};
+
+class CargoFilterStrategy : public KDevelop::IFilterStrategy
+{
+public:
+    explicit CargoFilterStrategy(const QUrl& buildDir,
+                                 const QSharedPointer<CargoClassifiedItems>& classifiedItems = QSharedPointer<CargoClassifiedItems>());
+    virtual ~CargoFilterStrategy();
+
+    KDevelop::FilteredItem errorInLine(const QString& line) override;
+    KDevelop::FilteredItem actionInLine(const QString& line) override;
+
+private:
+    QUrl urlForFile(const QStringRef& fileName);
+
+    enum { MaxCachedUrls = 64 };
+
+    KDevelop::Path buildDir;
+    QSharedPointer<CargoClassifiedItems> classifiedItems;
+    QString currentFile;
+    QUrl currentUrl;
+    QHash<QString, QUrl> urlCache;
+    KDevelop::FilteredItem::FilteredOutputItemType currentItemType;
+};
+
+#endif
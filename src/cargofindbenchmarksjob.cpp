@@ -0,0 +1,602 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargofindbenchmarksjob.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QProcess>
+#include <KLocalizedString>
+
+#include <interfaces/icore.h>
+#include <interfaces/iproject.h>
+#include <interfaces/iruncontroller.h>
+#include <interfaces/itestcontroller.h>
+#include <interfaces/itestsuite.h>
+#include <outputview/outputjob.h>
+#include <outputview/outputmodel.h>
+#include <util/commandexecutor.h>
+#include <util/processlinemaker.h>
+#include <language/duchain/indexeddeclaration.h>
+
+#include "cargobenchmarkresults.h"
+#include "cargocache.h"
+#include "cargofindtestsjob.h"
+#include "cargoplugin.h"
+#include "debug.h"
+
+using namespace KDevelop;
+
+class CargoBenchmarkSuite : public KDevelop::ITestSuite
+{
+public:
+    enum Harness
+    {
+        LibtestHarness,
+        CriterionHarness
+    };
+
+    CargoBenchmarkSuite(const QString& suiteName, const Path& executable, const QStringList& benchmarks, Harness harness,
+                        IProject* project)
+    : m_suiteName(suiteName)
+    , m_executable(executable)
+    , m_benchmarks(benchmarks)
+    , m_harness(harness)
+    , m_project(project)
+    {}
+
+    QString name() const override { return m_suiteName; }
+    Path executable() const { return m_executable; }
+    QStringList cases() const override { return m_benchmarks; }
+    Harness harness() const { return m_harness; }
+    KDevelop::IProject * project() const override { return m_project; }
+
+    KDevelop::IndexedDeclaration declaration() const override
+    {
+        return IndexedDeclaration();
+    }
+
+    KDevelop::IndexedDeclaration caseDeclaration(const QString & testCase) const override
+    {
+        Q_UNUSED(testCase);
+        return IndexedDeclaration();
+    }
+
+    KJob * launchCase(const QString & testCase, KDevelop::ITestSuite::TestJobVerbosity verbosity) override;
+    KJob * launchAllCases(KDevelop::ITestSuite::TestJobVerbosity verbosity) override;
+    KJob * launchCases(const QStringList & testCases, KDevelop::ITestSuite::TestJobVerbosity verbosity) override;
+
+private:
+    QString m_suiteName;
+    Path m_executable;
+    QStringList m_benchmarks;
+    Harness m_harness;
+    IProject* m_project;
+};
+
+/**
+ * Measures the whole suite, or the selected benchmarks of a suite.
+ *
+ * Benchmarks disturb each other's measurements, so unlike test processes they are not run by the
+ * CargoTestScheduler, but one process at a time once the job is started. Selected benchmarks run
+ * in a process each, with an exact filter, as Criterion accepts only a single filter.
+ *
+ * libtest results are parsed from the output as they come. Criterion's estimates are read from
+ * its directory once all processes are done. Either way, the estimates are shown at the end
+ * of the output, and recorded in CargoBenchmarkResults.
+ */
+class CargoRunBenchmarksJob : public KDevelop::OutputJob
+{
+    Q_OBJECT
+public:
+    CargoRunBenchmarksJob(CargoBenchmarkSuite* suite, const QStringList& caseNames, KDevelop::ITestSuite::TestJobVerbosity verbosity)
+    : KDevelop::OutputJob()
+    , killed(false)
+    , failed(false)
+    , processError(false)
+    , suite(suite)
+    , caseNames(caseNames)
+    , verbosity(verbosity)
+    , process(nullptr)
+    {
+        setCapabilities( Killable );
+
+        model = new KDevelop::OutputModel();
+        setModel( model );
+
+        if (caseNames.isEmpty())
+        {
+            pendingArguments.enqueue({ QStringLiteral("--bench") });
+        }
+        for (const auto& caseName : caseNames)
+        {
+            pendingArguments.enqueue({ QStringLiteral("--bench"), caseName, QStringLiteral("--exact") });
+        }
+
+        model->appendLine( QStringLiteral("Benchmark %1 %2").arg( suite->name() ).arg( caseNames.join(QLatin1Char(' ')) ) );
+    }
+
+    ~CargoRunBenchmarksJob() override
+    {
+        killProcess();
+    }
+
+    void start() override
+    {
+        setStandardToolView( KDevelop::IOutputView::TestView );
+        setVerbosity( verbosity == ITestSuite::Verbose ? KDevelop::OutputJob::Verbose : KDevelop::OutputJob::Silent );
+        setBehaviours( KDevelop::IOutputView::AllowUserClose | KDevelop::IOutputView::AutoScroll );
+
+        startOutput();
+
+        startTime = QDateTime::currentDateTime();
+        ICore::self()->testController()->notifyTestRunStarted(suite, caseNames.isEmpty() ? suite->cases() : caseNames);
+        startNextProcess();
+    }
+
+    bool doKill() override
+    {
+        killed = true;
+        killProcess();
+        return true;
+    }
+
+private:
+    void startNextProcess();
+    void processFinished();
+    void killProcess();
+    void parseOutput(const QStringList& lines);
+    void finish();
+
+    bool killed;
+    bool failed;
+    bool processError;
+    CargoBenchmarkSuite* suite;
+    QStringList caseNames;
+    ITestSuite::TestJobVerbosity verbosity;
+    KDevelop::OutputModel* model;
+    QQueue<QStringList> pendingArguments;
+    QProcess* process;
+    QDateTime startTime;
+    QHash<QString, TestResult::TestCaseResult> caseResults;
+    QVector<CargoBenchmarkResults::Estimate> estimates;
+};
+
+void CargoRunBenchmarksJob::startNextProcess()
+{
+    if (killed)
+    {
+        return;
+    }
+    if (pendingArguments.isEmpty())
+    {
+        finish();
+        return;
+    }
+
+    const QStringList arguments = pendingArguments.dequeue();
+    qCDebug(KDEV_CARGO) << "Starting benchmark process" << suite->executable() << arguments;
+
+    // Criterion writes its estimates to the criterion directory of the target directory it guesses, unless told otherwise
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QStringLiteral("CRITERION_HOME"), CargoBenchmarkResults::criterionDirectory(suite->project()));
+
+    process = new QProcess(this);
+    process->setProgram(suite->executable().toLocalFile());
+    process->setArguments(arguments);
+    process->setProcessEnvironment(environment);
+    process->setWorkingDirectory(suite->project()->path().toLocalFile());
+    auto lineMaker = new ProcessLineMaker(process, process);
+
+    connect(lineMaker, &ProcessLineMaker::receivedStdoutLines, this, &CargoRunBenchmarksJob::parseOutput);
+    connect(lineMaker, &ProcessLineMaker::receivedStderrLines, model, &OutputModel::appendLines);
+    connect(process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, [this, lineMaker](int code, QProcess::ExitStatus status) {
+        lineMaker->flushBuffers();
+        if (status != QProcess::NormalExit)
+        {
+            processError = true;
+        }
+        else if (code != 0)
+        {
+            failed = true;
+        }
+        processFinished();
+    });
+    connect(process, static_cast<void(QProcess::*)(QProcess::ProcessError)>(&QProcess::error),
+            this, [this](QProcess::ProcessError error) {
+        // Crashes are reported when the process finished
+        if (error == QProcess::FailedToStart)
+        {
+            processError = true;
+            processFinished();
+        }
+    });
+
+    process->start();
+}
+
+void CargoRunBenchmarksJob::processFinished()
+{
+    process->deleteLater();
+    process = nullptr;
+    startNextProcess();
+}
+
+void CargoRunBenchmarksJob::killProcess()
+{
+    pendingArguments.clear();
+    if (process)
+    {
+        process->disconnect(this);
+        process->kill();
+        process->deleteLater();
+        process = nullptr;
+    }
+}
+
+void CargoRunBenchmarksJob::parseOutput(const QStringList& lines)
+{
+    model->appendLines(lines);
+
+    for (const auto& line : lines)
+    {
+        CargoBenchmarkResults::Estimate estimate = { suite->name(), QString(), 0, 0, 0, 0, -1, QDateTime::currentDateTime() };
+        if (CargoBenchmarkResults::parseLibtestLine(line, &estimate))
+        {
+            estimates << estimate;
+            caseResults.insert(estimate.benchmarkName, TestResult::Passed);
+        }
+        else if (line.startsWith(QLatin1String("test ")) && line.endsWith(QLatin1String(" ... FAILED")))
+        {
+            // A benchmark that panics is reported like a failing test, and libtest runs the tests of the harness as well
+            const QString name = line.mid(5, line.size() - 16);
+            if (suite->cases().contains(name))
+            {
+                caseResults.insert(name, TestResult::Failed);
+            }
+        }
+    }
+}
+
+void CargoRunBenchmarksJob::finish()
+{
+    const QStringList benchmarks = caseNames.isEmpty() ? suite->cases() : caseNames;
+
+    if (suite->harness() == CargoBenchmarkSuite::CriterionHarness)
+    {
+        // Other suites share Criterion's directory, so only the benchmarks of this run are taken
+        const QString directory = CargoBenchmarkResults::criterionDirectory(suite->project());
+        for (auto estimate : CargoBenchmarkResults::readCriterionEstimates(directory, startTime))
+        {
+            if (benchmarks.contains(estimate.benchmarkName))
+            {
+                estimate.suiteName = suite->name();
+                estimates << estimate;
+                caseResults.insert(estimate.benchmarkName, TestResult::Passed);
+            }
+        }
+    }
+
+    // Benchmarks without an estimate did not finish, which is an error if their process failed
+    for (const auto& benchmark : benchmarks)
+    {
+        if (!caseResults.contains(benchmark))
+        {
+            caseResults.insert(benchmark, failed || processError ? TestResult::Error : TestResult::NotRun);
+        }
+    }
+
+    if (!estimates.isEmpty())
+    {
+        model->appendLine(QString());
+        model->appendLine(i18np("Estimate of %1 benchmark:", "Estimates of %1 benchmarks:", estimates.size()));
+    }
+    for (const auto& estimate : estimates)
+    {
+        if (estimate.confidenceLevel > 0)
+        {
+            model->appendLine(i18nc("<benchmark>: <time> (<lower bound> to <upper bound>, <level>% confidence)",
+                                    "%1: %2 (%3 to %4, %5% confidence)",
+                                    estimate.benchmarkName,
+                                    CargoBenchmarkResults::formatTime(estimate.time),
+                                    CargoBenchmarkResults::formatTime(estimate.lowerBound),
+                                    CargoBenchmarkResults::formatTime(estimate.upperBound),
+                                    qRound(estimate.confidenceLevel * 100)));
+        }
+        else
+        {
+            model->appendLine(i18nc("<benchmark>: <time> (<lower bound> to <upper bound> of the samples)",
+                                    "%1: %2 (%3 to %4 of the samples)",
+                                    estimate.benchmarkName,
+                                    CargoBenchmarkResults::formatTime(estimate.time),
+                                    CargoBenchmarkResults::formatTime(estimate.lowerBound),
+                                    CargoBenchmarkResults::formatTime(estimate.upperBound)));
+        }
+    }
+    CargoBenchmarkResults(CargoBenchmarkResults::fileName(suite->project())).addEstimates(estimates);
+
+    TestResult result;
+    for (auto it = caseResults.constBegin(); it != caseResults.constEnd(); ++it)
+    {
+        result.testCaseResults.insert(it.key(), it.value());
+    }
+
+    if (processError)
+    {
+        setError( FailedShownError );
+        setErrorText( i18n( "Error running benchmark command." ) );
+        result.suiteResult = TestResult::Error;
+    }
+    else if (failed)
+    {
+        setError( FailedShownError );
+        result.suiteResult = TestResult::Failed;
+    }
+    else
+    {
+        result.suiteResult = TestResult::Passed;
+    }
+
+    ICore::self()->testController()->notifyTestRunFinished(suite, result);
+    emitResult();
+}
+
+KJob* CargoBenchmarkSuite::launchCases(const QStringList & testCases, KDevelop::ITestSuite::TestJobVerbosity verbosity)
+{
+    return new CargoRunBenchmarksJob(this, testCases, verbosity);
+}
+
+KJob * CargoBenchmarkSuite::launchCase(const QString& testCase, KDevelop::ITestSuite::TestJobVerbosity verbosity)
+{
+    return new CargoRunBenchmarksJob(this, { testCase }, verbosity);
+}
+
+KJob * CargoBenchmarkSuite::launchAllCases(KDevelop::ITestSuite::TestJobVerbosity verbosity)
+{
+    return new CargoRunBenchmarksJob(this, QStringList(), verbosity);
+}
+
+CargoFindBenchmarksJob::CargoFindBenchmarksJob(CargoPlugin* plugin, KDevelop::IProject* project)
+ : KJob(plugin)
+ , plugin(plugin)
+ , project(project)
+ , hasBenchmarkExecutables(false)
+ , runAfterFinding(false)
+ , exec(nullptr)
+ , killed(false)
+{
+    setCapabilities( Killable );
+
+    builddir = plugin->buildDirectory( project->projectItem() ).toLocalFile();
+
+    QString title = i18n("Find benchmarks for Cargo project %1", project->name());
+    setObjectName(title);
+}
+
+void CargoFindBenchmarksJob::setBenchmarkExecutables(const QMap<QString, QString>& executables)
+{
+    benchmarkExecutables = executables;
+    hasBenchmarkExecutables = true;
+}
+
+void CargoFindBenchmarksJob::setRunAfterFinding(bool run)
+{
+    runAfterFinding = run;
+}
+
+QString CargoFindBenchmarksJob::suiteNameForTarget(const QString& targetName)
+{
+    // Benches are usually test targets as well, so their test suites already use the crate name
+    return CargoFindTestsJob::suiteNameForTarget(targetName) + QStringLiteral(" (bench)");
+}
+
+QStringList CargoFindBenchmarksJob::parseBenchmarkList(const QStringList& lines, bool* criterion)
+{
+    QStringList benchmarks;
+    *criterion = false;
+    for (const auto& line : lines)
+    {
+        if (line.endsWith(QLatin1String(": bench")))
+        {
+            benchmarks << line.left(line.size() - 7);
+        }
+        else if (line.endsWith(QLatin1String(": benchmark")))
+        {
+            benchmarks << line.left(line.size() - 11);
+            *criterion = true;
+        }
+    }
+    return benchmarks;
+}
+
+QMap<QString, QString> CargoFindBenchmarksJob::loadBenchmarkExecutables() const
+{
+    const QJsonObject cached = CargoCache(CargoPlugin::dataDirectory(project) + QStringLiteral("/bench-executables.json")).load();
+
+    QMap<QString, QString> executables;
+    for (auto it = cached.constBegin(); it != cached.constEnd(); ++it)
+    {
+        if (QFileInfo::exists(it.key()))
+        {
+            executables.insert(it.key(), it.value().toString());
+        }
+    }
+    return executables;
+}
+
+void CargoFindBenchmarksJob::storeBenchmarkExecutables(const QMap<QString, QString>& executables) const
+{
+    QJsonObject data;
+    for (auto it = executables.constBegin(); it != executables.constEnd(); ++it)
+    {
+        data.insert(it.key(), it.value());
+    }
+    CargoCache(CargoPlugin::dataDirectory(project) + QStringLiteral("/bench-executables.json")).store(data, {});
+}
+
+void CargoFindBenchmarksJob::start()
+{
+    if (hasBenchmarkExecutables)
+    {
+        // Other packages may have been built before, so their harnesses are still remembered
+        QMap<QString, QString> known = loadBenchmarkExecutables();
+        const QList<QString> builtNames = benchmarkExecutables.values();
+        for (auto it = known.begin(); it != known.end();)
+        {
+            // A harness of a target that was built again is left over from an older build
+            it = builtNames.contains(it.value()) ? known.erase(it) : it + 1;
+        }
+        for (auto it = benchmarkExecutables.constBegin(); it != benchmarkExecutables.constEnd(); ++it)
+        {
+            known.insert(it.key(), it.value());
+        }
+        storeBenchmarkExecutables(known);
+
+        // Like test suites, benchmark suites are named after their crates unless that is ambiguous
+        const QMap<QString, QString> uniqueNames = CargoFindTestsJob::uniqueSuiteNames(known);
+        suiteNames.clear();
+        for (auto it = benchmarkExecutables.constBegin(); it != benchmarkExecutables.constEnd(); ++it)
+        {
+            suiteNames.insert(it.key(), uniqueNames.value(it.key()) + QStringLiteral(" (bench)"));
+        }
+    }
+    else
+    {
+        // Benchmark harnesses are only known once `cargo bench` built them, so the target directory is not scanned
+        suiteNames = CargoFindTestsJob::uniqueSuiteNames(loadBenchmarkExecutables());
+        for (auto& suiteName : suiteNames)
+        {
+            suiteName += QStringLiteral(" (bench)");
+        }
+    }
+
+    pendingExecutables.clear();
+    for (auto it = suiteNames.constBegin(); it != suiteNames.constEnd(); ++it)
+    {
+        pendingExecutables.enqueue(it.key());
+    }
+
+    setTotalAmount( KJob::Files, pendingExecutables.size() );
+    setProcessedAmount( KJob::Files, 0 );
+
+    listNext();
+}
+
+bool CargoFindBenchmarksJob::doKill()
+{
+    killed = true;
+    pendingExecutables.clear();
+    if (exec)
+    {
+        exec->kill();
+    }
+    return true;
+}
+
+void CargoFindBenchmarksJob::listNext()
+{
+    if (killed)
+    {
+        return;
+    }
+
+    if (pendingExecutables.isEmpty())
+    {
+        ITestController* testController = plugin->core()->testController();
+        for (const auto& suiteName : foundSuites)
+        {
+            ITestSuite* suite = runAfterFinding ? testController->findTestSuite(project, suiteName) : nullptr;
+            if (suite)
+            {
+                qCDebug(KDEV_CARGO) << "Running benchmark suite" << suiteName;
+                plugin->core()->runController()->registerJob(suite->launchAllCases(ITestSuite::Verbose));
+            }
+        }
+
+        emitResult();
+        return;
+    }
+
+    const QString executable = pendingExecutables.dequeue();
+    const QString suiteName = suiteNames.value(executable);
+
+    qCDebug(KDEV_CARGO) << "Finding benchmarks in executable" << executable << ", suite" << suiteName;
+
+    // Listing is quick, and harnesses are few, so they are listed one after another
+    listedLines.clear();
+    exec = new KDevelop::CommandExecutor( executable, this );
+    exec->setArguments( { QStringLiteral("--bench"), QStringLiteral("--list") } );
+    exec->setWorkingDirectory( builddir );
+
+    connect( exec, &CommandExecutor::receivedStandardOutput, this, [this](const QStringList& lines) {
+        listedLines << lines;
+    });
+    connect( exec, &CommandExecutor::completed, this, [this, suiteName, executable](int code) {
+        listingFinished(suiteName, executable, code == 0);
+    });
+    connect( exec, &CommandExecutor::failed, this, [this, suiteName, executable]() {
+        listingFinished(suiteName, executable, false);
+    });
+
+    exec->start();
+}
+
+void CargoFindBenchmarksJob::listingFinished(const QString& suiteName, const QString& executable, bool success)
+{
+    if (killed)
+    {
+        return;
+    }
+
+    exec->deleteLater();
+    exec = nullptr;
+
+    bool criterion = false;
+    const QStringList benchmarks = parseBenchmarkList(listedLines, &criterion);
+    if (!success)
+    {
+        qCDebug(KDEV_CARGO) << "Could not list benchmarks of" << executable;
+    }
+    else if (!benchmarks.isEmpty())
+    {
+        const CargoBenchmarkSuite::Harness harness = criterion ? CargoBenchmarkSuite::CriterionHarness : CargoBenchmarkSuite::LibtestHarness;
+        const Path executablePath(executable);
+
+        // Adding a suite resets it in the test view, so a suite is only replaced when it changed
+        ITestController* testController = plugin->core()->testController();
+        auto existing = dynamic_cast<CargoBenchmarkSuite*>(testController->findTestSuite(project, suiteName));
+        if (!existing || existing->executable() != executablePath || existing->cases() != benchmarks || existing->harness() != harness)
+        {
+            testController->addTestSuite(new CargoBenchmarkSuite(suiteName, executablePath, benchmarks, harness, project));
+        }
+        foundSuites << suiteName;
+    }
+
+    setProcessedAmount( KJob::Files, processedAmount( KJob::Files ) + 1 );
+    emitPercent( processedAmount( KJob::Files ), totalAmount( KJob::Files ) );
+
+    listNext();
+}
+
+#include "cargofindbenchmarksjob.moc"
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOFINDBENCHMARKSJOB_H
+#define CARGOFINDBENCHMARKSJOB_H
+
+#include <KJob>
+#include <QMap>
+#include <QQueue>
+#include <QStringList>
+
+class CargoPlugin;
+namespace KDevelop
+{
+class CommandExecutor;
+class IProject;
+}
+
+/**
+ * Finds the benchmarks in harnesses built by `cargo bench --no-run`, and registers them as test suites of their own kind.
+ *
+ * Every harness is listed by running it with --bench --list. Harnesses without benchmarks,
+ * such as library targets without #[bench] functions, are not registered.
+ * Running a benchmark suite from the test view measures its benchmarks one process at a time,
+ * and records their estimates in CargoBenchmarkResults.
+ */
+class CargoFindBenchmarksJob : public KJob
+{
+Q_OBJECT
+public:
+    CargoFindBenchmarksJob(CargoPlugin* plugin, KDevelop::IProject* project);
+
+    /**
+     * Look for benchmarks only in @p executables, which map benchmark harnesses to their qualified suite names,
+     * see CargoFindTestsJob::qualifiedSuiteName().
+     *
+     * These are usually the artifacts reported by the build that just finished.
+     * Without them, the job uses the harnesses it found the last time.
+     */
+    void setBenchmarkExecutables(const QMap<QString, QString>& executables);
+
+    /// Run all suites found by this job once they are registered
+    void setRunAfterFinding(bool run);
+
+    /// @return the suite name for benchmarks of target @p targetName, which differs from the name of its test suite
+    static QString suiteNameForTarget(const QString& targetName);
+
+    /**
+     * Parses the output of a benchmark harness run with --bench --list.
+     *
+     * libtest lists benchmarks as "name: bench", next to its tests, and Criterion as "name: benchmark".
+     *
+     * @param criterion set to whether the benchmarks are Criterion benchmarks
+     * @return the names of the benchmarks in @p lines
+     */
+    static QStringList parseBenchmarkList(const QStringList& lines, bool* criterion);
+
+    void start() override;
+    bool doKill() override;
+
+private:
+    QMap<QString, QString> loadBenchmarkExecutables() const;
+    void storeBenchmarkExecutables(const QMap<QString, QString>& executables) const;
+
+    void listNext();
+    void listingFinished(const QString& suiteName, const QString& executable, bool success);
+
+    CargoPlugin* plugin;
+    KDevelop::IProject* project;
+    QString builddir;
+
+    QMap<QString, QString> benchmarkExecutables;
+    bool hasBenchmarkExecutables;
+    bool runAfterFinding;
+
+    /// Harnesses that are not listed yet, by executable
+    QQueue<QString> pendingExecutables;
+    QMap<QString, QString> suiteNames;
+    KDevelop::CommandExecutor* exec;
+    QStringList listedLines;
+    QStringList foundSuites;
+
+    bool killed;
+};
+
+#endif
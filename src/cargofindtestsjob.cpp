@@ -22,7 +22,23 @@
 
 #include "cargofindtestsjob.h"
 
+#include <algorithm>
+
+#include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QThread>
+#include <QTimer>
+#include <QtConcurrentRun>
+#include <KConfigGroup>
 #include <KLocalizedString>
 #include <KShell>
 
@@ -36,24 +52,86 @@
 #include <outputview/filtereditem.h>
 #include <outputview/outputfilteringstrategies.h>
 #include <util/commandexecutor.h>
-#include <util/executecompositejob.h>
 #include <project/projectmodel.h>
 #include <language/duchain/indexeddeclaration.h>
 
+#include "cargocache.h"
+#include "cargodepinfoindex.h"
+#include "cargoelftestreader.h"
+#include "cargomessageparser.h"
 #include "cargoplugin.h"
+#include "cargotestcasetree.h"
+#include "cargotesthistory.h"
+#include "cargostackdump.h"
+#include "cargotestscheduler.h"
 #include "debug.h"
 
 using namespace KDevelop;
 
+namespace
+{
+
+/// The crate name of a qualified suite name is between the package and the kind, neither of which contains these separators
+QString crateName(const QString& qualifiedName)
+{
+    const int kind = qualifiedName.indexOf(QLatin1String(" ("));
+    const QString name = kind == -1 ? qualifiedName : qualifiedName.left(kind);
+    const int package = name.indexOf(QLatin1String("::"));
+    return package == -1 ? name : name.mid(package + 2);
+}
+
+/**
+ * Profiles are built into <target>/<profile>, or into <target>/<triple>/<profile> when cross-compiling,
+ * and their test executables are linked in the deps directory.
+ *
+ * @return the profile directory of @p targetDirectory that was built last, or an empty string if there is none
+ */
+QString latestProfileDirectory(const QString& targetDirectory)
+{
+    QStringList candidates;
+    for (const auto& info : QDir(targetDirectory).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        candidates << info.absoluteFilePath();
+        for (const auto& nested : QDir(info.absoluteFilePath()).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot))
+        {
+            candidates << nested.absoluteFilePath();
+        }
+    }
+
+    QString latest;
+    QDateTime latestBuild;
+    for (const auto& candidate : candidates)
+    {
+        const QFileInfo deps(candidate + QStringLiteral("/deps"));
+        if (deps.isDir() && (latest.isEmpty() || deps.lastModified() > latestBuild))
+        {
+            latest = candidate;
+            latestBuild = deps.lastModified();
+        }
+    }
+    return latest;
+}
+
+}
+
 class CargoTestSuite : public KDevelop::ITestSuite
 {
 public:
-    CargoTestSuite(const QString& suiteName, const Path& executable, const QStringList& cases, const QStringList& ignoredCases, IProject* project);
+    /// Whether the test harness accepts more than one filter, which is only known after asking it, see findHarnessFeatures()
+    enum FilterSupport
+    {
+        UnknownFilterSupport,
+        SingleFilter,
+        MultipleFilters
+    };
+
+    CargoTestSuite(const QString& suiteName, const Path& executable, const CargoTestCaseTree& cases,
+                   IProject* project, CargoTestScheduler* scheduler);
     virtual ~CargoTestSuite();
 
     QString name() const override { return m_suiteName; }
     Path executable() const { return m_executable; }
-    QStringList cases() const override { return m_cases; }
+    QStringList cases() const override { return m_cases.cases(); }
     KDevelop::IProject * project() const override { return m_project; }
 
     KDevelop::IndexedDeclaration declaration() const override
@@ -67,11 +145,33 @@ public:
         return IndexedDeclaration();
     }
 
-    bool isIgnored(const QString& caseName)
+    bool isIgnored(const QString& caseName) const
     {
-        return m_ignoredCases.contains(caseName);
+        return m_cases.isIgnored(caseName);
     }
 
+    /// The cases of the suite, which can be looked up without building the list of their names like cases() does
+    const CargoTestCaseTree& caseTree() const { return m_cases; }
+
+    /// Runs the test processes of this suite, null once the plugin is unloaded
+    CargoTestScheduler* scheduler() const { return m_scheduler; }
+
+    FilterSupport filterSupport() const { return m_filterSupport; }
+    void setFilterSupport(FilterSupport support) { m_filterSupport = support; }
+
+    /// Whether the test harness reports the time of each case with --report-time, known together with filterSupport()
+    bool reportsTime() const { return m_reportsTime; }
+    void setReportsTime(bool reportsTime) { m_reportsTime = reportsTime; }
+
+    /// The result of each case in the last run that included it
+    QHash<QString, KDevelop::TestResult::TestCaseResult> lastResults() const { return m_lastResults; }
+    void addResults(const QHash<QString, KDevelop::TestResult::TestCaseResult>& results);
+
+    /// @return the cases that failed, or could not be run, the last time they were run
+    QStringList failedCases() const;
+
+    KJob* launchRepeatedCases(const QStringList& testCases, int repeat, bool stopOnFailure);
+
     KJob * launchCase(const QString & testCase, KDevelop::ITestSuite::TestJobVerbosity verbosity) override;
     KJob * launchAllCases(KDevelop::ITestSuite::TestJobVerbosity verbosity) override;
     KJob * launchCases(const QStringList & testCases, KDevelop::ITestSuite::TestJobVerbosity verbosity) override;
@@ -79,33 +179,129 @@ public:
 private:
     QString m_suiteName;
     Path m_executable;
-    QStringList m_cases;
-    QStringList m_ignoredCases;
+    CargoTestCaseTree m_cases;
     IProject* m_project;
+    QPointer<CargoTestScheduler> m_scheduler;
+    FilterSupport m_filterSupport;
+    bool m_reportsTime;
+    QHash<QString, KDevelop::TestResult::TestCaseResult> m_lastResults;
 };
 
-CargoTestSuite::CargoTestSuite(const QString& suiteName, const KDevelop::Path& executable, const QStringList& cases, const QStringList& ignoredCases, KDevelop::IProject* project)
+CargoTestSuite::CargoTestSuite(const QString& suiteName, const KDevelop::Path& executable, const CargoTestCaseTree& cases,
+                               KDevelop::IProject* project, CargoTestScheduler* scheduler)
  : m_suiteName(suiteName)
  , m_executable(executable)
  , m_cases(cases)
- , m_ignoredCases(ignoredCases)
  , m_project(project)
+ , m_scheduler(scheduler)
+ , m_filterSupport(UnknownFilterSupport)
+ , m_reportsTime(false)
 {}
 
 CargoTestSuite::~CargoTestSuite()
 {}
 
+void CargoTestSuite::addResults(const QHash<QString, KDevelop::TestResult::TestCaseResult>& results)
+{
+    for (auto it = results.constBegin(); it != results.constEnd(); ++it)
+    {
+        if (m_cases.contains(it.key()))
+        {
+            m_lastResults.insert(it.key(), it.value());
+        }
+    }
+}
+
+QStringList CargoTestSuite::failedCases() const
+{
+    QStringList cases;
+    for (int i = 0; i < m_cases.size(); ++i)
+    {
+        const QString caseName = m_cases.caseAt(i);
+        const TestResult::TestCaseResult result = m_lastResults.value(caseName, TestResult::NotRun);
+        if (result == TestResult::Failed || result == TestResult::Error)
+        {
+            cases << caseName;
+        }
+    }
+    return cases;
+}
+
+/**
+ * Runs the whole suite, or the selected test cases of a suite.
+ *
+ * Selected cases are passed as exact filters, as many as fit on a command line,
+ * so that running many cases does not mean starting as many processes.
+ * Test harnesses that accept only a single filter run one case per process.
+ *
+ * A whole suite can be split into shards, which run in separate processes with exact filters
+ * for their cases. Their results are merged into a single result of the suite.
+ *
+ * The processes are queued in the plugin's CargoTestScheduler once the job is started,
+ * and their output is collected in the job's own output model.
+ *
+ * Results are not streamed to the test view. ITestController can only report results through testRunFinished(),
+ * and ProjectTestJob counts every such signal as a finished suite, so the test controller gets a single result
+ * once the run is finished. Until then, each finished case shows up in the output as soon as its process reports it,
+ * and is counted in the progress of the job.
+ *
+ * Selected cases can also be repeated, with each repetition in processes of its own, so that repetitions run
+ * in parallel. A case fails if any of its repetitions failed, and the pass rate and the spread of times
+ * of every case are shown in the output once all repetitions are done, or once the first one failed.
+ */
 class CargoRunTestsJob : public KDevelop::OutputJob
 {
     Q_OBJECT
 public:
-    CargoRunTestsJob(CargoTestSuite* suite, const QString& caseName, KDevelop::ITestSuite::TestJobVerbosity verbosity)
+    /// Limits the length of the filters in a single command line, well below what any platform allows
+    enum { MaxFiltersLength = 32 * 1024 };
+
+    /// How often running processes are checked for timeouts
+    enum { WatchdogInterval = 1000 };
+
+    CargoRunTestsJob(CargoTestSuite* suite, const QStringList& caseNames, KDevelop::ITestSuite::TestJobVerbosity verbosity,
+                     int repeat = 1, bool stopOnFailure = false)
     : KDevelop::OutputJob()
     , killed(false)
+    , started(false)
+    , failed(false)
+    , processError(false)
+    , caseFailed(false)
     , suite(suite)
-    , caseName(caseName)
+    , caseNames(caseNames)
     , verbosity(verbosity)
+    , exec(nullptr)
+    , repeat(qMax(1, repeat))
+    , stopOnFailure(stopOnFailure)
+    , startTime(QDateTime::currentDateTime())
+    {
+        KConfigGroup config( suite->project()->projectConfiguration(), "Cargo" );
+        order = CargoFindTestsJob::testOrder( config.readEntry( "Test Order", QString() ) );
+        caseTimeout = config.readEntry( "Test Case Timeout", 0 );
+        suiteTimeout = config.readEntry( "Test Suite Timeout", 0 );
+        if (caseNames.isEmpty())
+        {
+            shards = CargoFindTestsJob::shardCount( config.readEntry( "Test Shards", QString() ), suite->name() );
+        }
+        else
+        {
+            shards = 1;
+        }
+
+        model = new KDevelop::OutputModel();
+        setModel( model );
+
+        watchdog = new QTimer(this);
+        watchdog->setInterval(WatchdogInterval);
+        connect(watchdog, &QTimer::timeout, this, &CargoRunTestsJob::checkTimeouts);
+
+        model->appendLine( QStringLiteral("Test %1 %2").arg( suite->name() ).arg( caseNames.join(QLatin1Char(' ')) ) );
+    }
+
+    ~CargoRunTestsJob() override
     {
+        // Processes belong to the scheduler, so they would keep running after a job that was deleted without being killed
+        killProcesses();
     }
 
     TestResult::TestCaseResult parseResult(const QString& res)
@@ -128,322 +324,1628 @@ public:
 
     void start() override
     {
-        setStandardToolView(KDevelop::IOutputView::TestView);
-        QStringList arguments;
-        arguments << QStringLiteral("--test");
-
-        if (verbosity == ITestSuite::Verbose)
-        {
-            arguments << QStringLiteral("--nocapture");
-        }
-
-        if (!caseName.isEmpty())
-        {
-            arguments << QStringLiteral("--exact") << caseName;
-
-            if (suite->isIgnored(caseName))
-            {
-                // When running a single test case, we also allow running ignored cases.
-                // They will only be skipped when running the whole suite.
-                arguments << QStringLiteral("--ignored");
-            }
-        }
-
         setStandardToolView( KDevelop::IOutputView::TestView );
         setVerbosity( verbosity == ITestSuite::Verbose ? KDevelop::OutputJob::Verbose : KDevelop::OutputJob::Silent );
         setBehaviours( KDevelop::IOutputView::AllowUserClose | KDevelop::IOutputView::AutoScroll );
 
-        KDevelop::OutputModel* model = new KDevelop::OutputModel();
-        setModel( model );
-
         startOutput();
 
-        exec = new KDevelop::CommandExecutor( suite->executable().path(), this );
-
-        exec->setArguments( arguments );
-
-        connect( exec, &CommandExecutor::completed, this, &CargoRunTestsJob::procFinished );
-        connect( exec, &CommandExecutor::failed, this, &CargoRunTestsJob::procError );
+        started = true;
+        ICore::self()->testController()->notifyTestRunStarted(suite, caseNames.isEmpty() ? suite->cases() : caseNames);
 
-        connect( exec, &CommandExecutor::receivedStandardError, model, &OutputModel::appendLines );
-        connect( exec, &CommandExecutor::receivedStandardOutput, [this, model](const QStringList& lines) {
-            model->appendLines(lines);
+        setTotalAmount( KJob::Items, quint64(caseNames.isEmpty() ? suite->caseTree().size() : caseNames.size()) * repeat );
+        setProcessedAmount( KJob::Items, 0 );
 
-            for (auto& line : lines)
-            {
-                qCDebug(KDEV_CARGO) << "Received output line" << line;
-                QStringList elements = line.split(' ');
-                if (elements.size() == 4 && elements[0] == QStringLiteral("test"))
-                {
-                    QString testCase = elements[1];
-                    TestResult::TestCaseResult result = parseResult(elements[3]);
-
-                    qCDebug(KDEV_CARGO) << "Received test case result" << testCase << elements[3] << result;
-
-                    caseResults.insert(testCase, result);
-                }
-            }
-        });
-
-        model->appendLine( QStringLiteral("Test %1 %2").arg( suite->name() ).arg( caseName ) );
-        exec->start();
+        if (caseTimeout > 0 || suiteTimeout > 0)
+        {
+            watchdog->start();
+        }
 
-        if (caseName.isEmpty())
+        if (suite->filterSupport() == CargoTestSuite::UnknownFilterSupport)
         {
-            ICore::self()->testController()->notifyTestRunStarted(suite, {caseName});
+            findHarnessFeatures();
         }
         else
         {
-            ICore::self()->testController()->notifyTestRunStarted(suite, suite->cases());
+            scheduleBatches();
         }
     }
 
     bool doKill() override
     {
         killed = true;
-        exec->kill();
+        killProcesses();
+
+        // Results of the cases that finished before are still worth seeing, and the run has to end for the test view
+        watchdog->stop();
+        if (started)
+        {
+            TestResult result;
+            result.suiteResult = caseFailed ? TestResult::Failed : TestResult::NotRun;
+            for (auto it = caseResults.constBegin(); it != caseResults.constEnd(); ++it)
+            {
+                result.testCaseResults.insert(it.key(), it.value());
+            }
+            ICore::self()->testController()->notifyTestRunFinished(suite, result);
+        }
         return true;
     }
 
 private:
-
-    void procFinished(int);
-    void procError(QProcess::ProcessError);
+    void findHarnessFeatures();
+    void findReportTimeSupport(CargoTestSuite::FilterSupport filterSupport);
+    void scheduleBatches();
+    void killProcesses();
+    void processFinished(CargoTestProcess* process);
+    void finish();
+    void parseOutput(CargoTestProcess* process, const QStringList& lines);
+    void stopRepeating();
+    void reportRepetitions();
+
+    /// A test process with the cases it runs, and the filters that select them if it does not run the whole suite
+    struct Batch
+    {
+        QStringList arguments;
+        QStringList filters;
+        QStringList cases;
+        qint64 priority;
+        /// The most test threads the process can use, 0 for one per case
+        int threads;
+    };
+
+    struct RunningBatch
+    {
+        Batch batch;
+        QSet<QString> finishedCases;
+        /// Time since the process started or since its last case finished, invalid while it is waiting
+        QElapsedTimer progress;
+    };
+
+    /// @return batches that run @p cases with exact filters, as many as fit on a command line
+    QList<Batch> exactBatches(const QStringList& arguments, const QStringList& cases) const;
+    void scheduleBatch(const Batch& batch);
+
+    void checkTimeouts();
+
+    /**
+     * Dumps the stacks of @p process, which did not finish a case in time, and kills it.
+     * The case that hangs is reported as an error, and the cases that did not run yet continue in a new process.
+     * If the hanging case is not known, the unfinished cases are run again one at a time, and their results count instead.
+     *
+     * @param suiteTimedOut the whole suite took too long, so all unfinished cases are errors and none continue
+     */
+    void timedOut(CargoTestProcess* process, bool suiteTimedOut);
 
     bool killed;
+    bool started;
+    bool failed;
+    bool processError;
+    bool caseFailed;
     CargoTestSuite* suite;
-    QString caseName;
+    QStringList caseNames;
     ITestSuite::TestJobVerbosity verbosity;
+    CargoFindTestsJob::TestOrder order;
+    int shards;
+    KDevelop::OutputModel* model;
     KDevelop::CommandExecutor* exec;
+    QList<QPointer<CargoTestProcess>> processes;
     QHash<QString, TestResult::TestCaseResult> caseResults;
-};
 
+    /// Times of the cases in milliseconds, and what they are measured with if the harness does not report them
+    QHash<QString, qint64> caseTimes;
+    QHash<CargoTestProcess*, QElapsedTimer> caseTimers;
+    QElapsedTimer runTimer;
+
+    /// Every case is run this many times, and the results of the repetitions are counted for each case
+    int repeat;
+    bool stopOnFailure;
+    QHash<QString, int> casePasses;
+    QHash<QString, QVector<qint64>> repeatedTimes;
+
+    /// Timeouts in seconds, 0 for none
+    int caseTimeout;
+    int suiteTimeout;
+    QTimer* watchdog;
+    QHash<CargoTestProcess*, RunningBatch> runningBatches;
+
+    /// Sources changed after this time are not covered by the run
+    QDateTime startTime;
+};
 
-void CargoRunTestsJob::procError( QProcess::ProcessError err )
+void CargoRunTestsJob::findHarnessFeatures()
 {
-    Q_UNUSED(err);
-
-    if (killed)
-    {
-        return;
-    }
-
-    setError( FailedShownError );
-    setErrorText( i18n( "Error running test command." ) );
+    // The usage line shows "[FILTERS...]" for test harnesses that accept any number of filters
+    exec = new KDevelop::CommandExecutor( suite->executable().toLocalFile(), this );
+    exec->setArguments( { QStringLiteral("--help") } );
+
+    auto support = QSharedPointer<CargoTestSuite::FilterSupport>::create(CargoTestSuite::SingleFilter);
+    auto reportTime = QSharedPointer<bool>::create(false);
+    connect( exec, &CommandExecutor::receivedStandardOutput, this, [support, reportTime](const QStringList& lines) {
+        for (const auto& line : lines)
+        {
+            if (line.contains(QLatin1String("[FILTERS...]")))
+            {
+                *support = CargoTestSuite::MultipleFilters;
+            }
+            if (line.contains(QLatin1String("--report-time")))
+            {
+                *reportTime = true;
+            }
+        }
+    });
+    connect( exec, &CommandExecutor::completed, this, [this, support, reportTime]() {
+        if (*reportTime)
+        {
+            findReportTimeSupport(*support);
+            return;
+        }
+        suite->setFilterSupport(*support);
+        scheduleBatches();
+    });
+    connect( exec, &CommandExecutor::failed, this, [this]() {
+        // Running the cases will fail the same way, and report it
+        scheduleBatches();
+    });
+
+    exec->start();
+}
 
-    TestResult result;
-    result.suiteResult = TestResult::Error;
-    ICore::self()->testController()->notifyTestRunFinished(suite, result);
+void CargoRunTestsJob::findReportTimeSupport(CargoTestSuite::FilterSupport filterSupport)
+{
+    exec->deleteLater();
 
-    emitResult();
+    /*
+     * --report-time is unstable, so it is listed by every harness, but only accepted by those built by a nightly toolchain.
+     * It could be enabled with RUSTC_BOOTSTRAP, but that would also change how tests that run the compiler behave.
+     */
+    exec = new KDevelop::CommandExecutor( suite->executable().toLocalFile(), this );
+    exec->setArguments( { QStringLiteral("-Z"), QStringLiteral("unstable-options"), QStringLiteral("--report-time"), QStringLiteral("--list") } );
+
+    connect( exec, &CommandExecutor::completed, this, [this, filterSupport](int code) {
+        suite->setReportsTime(code == 0);
+        suite->setFilterSupport(filterSupport);
+        scheduleBatches();
+    });
+    connect( exec, &CommandExecutor::failed, this, [this, filterSupport]() {
+        suite->setFilterSupport(filterSupport);
+        scheduleBatches();
+    });
+
+    exec->start();
 }
 
-void CargoRunTestsJob::procFinished(int code)
+void CargoRunTestsJob::scheduleBatches()
 {
+    if (exec)
+    {
+        exec->deleteLater();
+        exec = nullptr;
+    }
+
     if (killed)
     {
         return;
     }
 
-    TestResult result;
+    QStringList arguments;
+    arguments << QStringLiteral("--test");
 
-    if (code != 0) {
-        setError(FailedShownError);
-        result.suiteResult = TestResult::Failed;
-    } else {
-        result.suiteResult = TestResult::Passed;
+    if (verbosity == ITestSuite::Verbose)
+    {
+        arguments << QStringLiteral("--nocapture");
     }
 
-    for (auto it = caseResults.constBegin(); it != caseResults.constEnd(); ++it)
+    if (suite->reportsTime())
     {
-        result.testCaseResults.insert(it.key(), it.value());
+        arguments << QStringLiteral("-Z") << QStringLiteral("unstable-options") << QStringLiteral("--report-time");
     }
 
-    ICore::self()->testController()->notifyTestRunFinished(suite, result);
-
-    emitResult();
-}
-
-KJob* CargoTestSuite::launchCases(const QStringList & testCases, KDevelop::ITestSuite::TestJobVerbosity verbosity)
-{
-    /*
-     * Rust test executable have no way of specifying a list of test cases to run.
-     * Either all test cases, or only a single test case can be specified at a time.
-     *
-     * To work around this, when a list of tests is specified, we run one job per test case,
-     * and run exactly one test case in each job.
-     */
-
-    Q_UNUSED(verbosity);
-    // We do not want to run multiple verbose jobs at the same time
-
-    QList<KJob*> jobs;
-    for (auto& testCase : testCases)
+    // Orders other than the default depend on what earlier runs recorded
+    CargoTestHistory::Entry suiteHistory = {};
+    QHash<QString, CargoTestHistory::Entry> caseHistory;
+    if (order != CargoFindTestsJob::DefaultOrder)
     {
-        jobs << launchCase(testCase, Silent);
+        CargoTestHistory history(CargoTestHistory::fileName(suite->project()));
+        suiteHistory = history.suite(suite->name());
+        caseHistory = history.suiteCases(suite->name());
     }
-    return new ExecuteCompositeJob(ICore::self()->runController(), jobs);
-}
-
-KJob * CargoTestSuite::launchCase(const QString& testCase, KDevelop::ITestSuite::TestJobVerbosity verbosity)
-{
-    return new CargoRunTestsJob(this, testCase, verbosity);
-}
 
-KJob * CargoTestSuite::launchAllCases(KDevelop::ITestSuite::TestJobVerbosity verbosity)
-{
-    return new CargoRunTestsJob(this, QString(), verbosity);
-}
+    // Failing cases come first, then flaky ones, which failed some time before
+    auto failureRank = [&caseHistory](const QString& caseName) {
+        const CargoTestHistory::Entry entry = caseHistory.value(caseName);
+        return entry.lastFailed ? 2 : entry.failures > 0 ? 1 : 0;
+    };
 
-CargoFindTestsJob::CargoFindTestsJob(CargoPlugin* plugin, KDevelop::ProjectBaseItem* item)
- : KJob(plugin)
- , plugin(plugin)
- , killed(false)
-{
-    setCapabilities( Killable );
+    // Longer processes start first, an expected time of 0 means it is not known
+    auto expectedTime = [&caseHistory](const QStringList& cases) {
+        qint64 time = 0;
+        for (const auto& caseName : cases)
+        {
+            time += caseHistory.value(caseName).averageTime;
+        }
+        return time;
+    };
 
-    project = item->project();
-    QString projectName = item->project()->name();
-    builddir = plugin->buildDirectory( item ).toLocalFile();
+    auto priority = [this, &failureRank, &expectedTime](const QStringList& cases) -> qint64 {
+        switch (order)
+        {
+            case CargoFindTestsJob::FailedFirstOrder:
+            {
+                int rank = 0;
+                for (const auto& caseName : cases)
+                {
+                    rank = qMax(rank, failureRank(caseName));
+                }
+                return rank;
+            }
+            case CargoFindTestsJob::LongestFirstOrder:
+                return expectedTime(cases);
+            default:
+                return 0;
+        }
+    };
 
-    QString title = i18n("Find tests for Cargo project %1", projectName);
-    setObjectName(title);
-}
+    QList<Batch> batches;
 
-void CargoFindTestsJob::start()
-{
-    QDir testDir(builddir + "/target/debug");
+    const bool multipleFilters = suite->filterSupport() == CargoTestSuite::MultipleFilters;
+    auto addBatches = [this, &batches, &priority](const QStringList& arguments, const QStringList& group) {
+        for (Batch batch : exactBatches(arguments, group))
+        {
+            batch.priority = priority(batch.cases);
+            batches << batch;
+        }
+    };
 
-    if (!testDir.exists())
-    {
-        setError( TargetsDirDoesNotExist );
-        setErrorText( i18n( "The targets directory %1 does not exist", testDir.path() ) );
-        emitResult();
-        return;
-    }
+    // With multiple filters, failing and flaky cases are split off to run in processes of their own before the others
+    auto splitByFailures = [&failureRank](const QStringList& cases) {
+        QVector<QStringList> groups(3);
+        for (const auto& caseName : cases)
+        {
+            groups[2 - failureRank(caseName)] << caseName;
+        }
+        return groups;
+    };
+    const bool failedFirst = order == CargoFindTestsJob::FailedFirstOrder && multipleFilters && !caseHistory.isEmpty();
 
-    executors.clear();
-    numExecutorsFinished = 0;
+    // Names of all cases are built from the suite's tree only once
+    const QStringList allCases = caseNames.isEmpty() ? suite->cases() : QStringList();
 
-    QDir::Filters filters = QDir::Files | QDir::Executable;
-    for (auto info : testDir.entryInfoList(filters))
+    if (caseNames.isEmpty() && (shards > 1 || failedFirst) && multipleFilters)
     {
         /*
-         * Test executable built by cargo are named
-         * <crate_name>-<hash>, where crate_name never includes dashes
-         * but may include underscores.
-         *
-         * We thus try to split each executable named into the (crate_name, hash)
-         * pair, then ignore the hash and use only the crate name as the
-         * test suite name.
+         * Without recorded times, shards are assigned round-robin from the sorted cases, so that the same case always runs
+         * in the same shard, and neighbouring cases, which tend to be similar, are spread over all shards.
+         * Ignored cases are passed as well, and reported as ignored like in a run of the whole suite.
          */
-
-        QStringList fileNameParts = info.fileName().split('-');
-        if (fileNameParts.size() != 2)
+        QStringList cases = allCases;
+        if (failedFirst)
         {
-            continue;
+            const QVector<QStringList> groups = splitByFailures(cases);
+            addBatches(arguments + QStringList{ QStringLiteral("--exact") }, groups[0]);
+            addBatches(arguments + QStringList{ QStringLiteral("--exact") }, groups[1]);
+            cases = groups[2];
         }
-        QString suiteName = fileNameParts.first();
-        QString executable = info.absoluteFilePath();
-
-        auto exec = new KDevelop::CommandExecutor( executable, this );
-
-        qCDebug(KDEV_CARGO) << "Finding tests in executable" << executable << "in dir" << builddir << ", suite" << suiteName;
-
-        exec->setArguments(QStringList() << QStringLiteral("--list"));
-        exec->setWorkingDirectory(builddir);
-
-        connect(exec, &CommandExecutor::completed, this, [this, suiteName, executable](int code){
-            procFinished(suiteName, executable, code);
-        } );
-        connect(exec, &CommandExecutor::failed, this, [this, suiteName](QProcess::ProcessError error){
-            procError(suiteName, error);
-        });
 
-        connect(exec, &CommandExecutor::receivedStandardOutput, this, [this, suiteName](const QStringList& output) {
-            addSuiteCases(suiteName, output);
-        });
+        QHash<QString, qint64> caseTimes;
+        if (order == CargoFindTestsJob::LongestFirstOrder)
+        {
+            for (auto it = caseHistory.constBegin(); it != caseHistory.constEnd(); ++it)
+            {
+                caseTimes.insert(it.key(), it.value().averageTime);
+            }
+        }
 
-        exec->start();
-        executors.append(exec);
+        for (const auto& shard : CargoFindTestsJob::assignShards(cases, caseTimes, shards))
+        {
+            addBatches(arguments + QStringList{ QStringLiteral("--exact") }, shard);
+        }
+    }
+    else if (caseNames.isEmpty())
+    {
+        qint64 suitePriority = priority(allCases);
+        if (order == CargoFindTestsJob::LongestFirstOrder && suiteHistory.runs > 0)
+        {
+            suitePriority = suiteHistory.averageTime;
+        }
+        batches << Batch{ arguments, QStringList(), allCases, suitePriority, 0 };
+    }
+    else
+    {
+        arguments << QStringLiteral("--exact");
 
         /*
-         * We separately track the list of ignored test cases.
-         * This is needed for the ability to run individual ignored test cases.
+         * Ignored cases are run only when selected, so they are run in their own batches with --ignored.
+         * They will only be skipped when running the whole suite.
          */
+        QStringList cases;
+        QStringList ignored;
+        for (const auto& caseName : caseNames)
+        {
+            (suite->isIgnored(caseName) ? ignored : cases) << caseName;
+        }
 
-        exec = new KDevelop::CommandExecutor( executable, this );
-        exec->setArguments(QStringList() << QStringLiteral("--list") << QStringLiteral("--ignored"));
-        exec->setWorkingDirectory(builddir);
-
-        connect(exec, &CommandExecutor::completed, this, [this, suiteName, executable](int code){
-            procFinished(suiteName, executable, code);
-        } );
-        connect(exec, &CommandExecutor::failed, this, [this, suiteName](QProcess::ProcessError error){
-            procError(suiteName, error);
-        });
+        if (failedFirst)
+        {
+            for (const auto& group : splitByFailures(cases))
+            {
+                addBatches(arguments, group);
+            }
+        }
+        else
+        {
+            addBatches(arguments, cases);
+        }
+        addBatches(arguments + QStringList{ QStringLiteral("--ignored") }, ignored);
+    }
 
-        connect(exec, &CommandExecutor::receivedStandardOutput, this, [this, suiteName](const QStringList& output) {
-            addIgnoredCases(suiteName, output);
-        });
+    CargoTestScheduler* scheduler = suite->scheduler();
+    if (scheduler)
+    {
+        QList<Batch> repeatedBatches;
+        for (int i = 0; i < repeat; ++i)
+        {
+            repeatedBatches += batches;
+        }
 
-        exec->start();
-        executors.append(exec);
+        for (const auto& batch : repeatedBatches)
+        {
+            scheduleBatch(batch);
+        }
     }
-}
-
-bool CargoFindTestsJob::doKill()
-{
-    killed = true;
-    for (auto exec : executors)
+    else
     {
-        exec->kill();
+        // The plugin is being unloaded
+        processError = true;
     }
-    return true;
-}
 
-void CargoFindTestsJob::procFinished(const QString& suiteName, const QString& executable, int)
-{
-    if (killed)
+    if (processes.isEmpty())
     {
-        return;
+        finish();
     }
+}
 
-    qCDebug(KDEV_CARGO) << "Proc finished" << suiteName;
-    numExecutorsFinished++;
+QList<CargoRunTestsJob::Batch> CargoRunTestsJob::exactBatches(const QStringList& arguments, const QStringList& cases) const
+{
+    QList<Batch> batches;
+    const bool multipleFilters = suite->filterSupport() == CargoTestSuite::MultipleFilters;
 
-    if (suiteCases.contains(suiteName))
+    QStringList batch;
+    int length = 0;
+    for (const auto& caseName : cases)
     {
-        QStringList all = suiteCases[suiteName];
-        QStringList ignored = ignoredCases.value(suiteName);
-
-        CargoTestSuite* suite = new CargoTestSuite(suiteName, Path(executable), all, ignored, project);
-        plugin->core()->testController()->addTestSuite(suite);
+        if (!batch.isEmpty() && (!multipleFilters || length + caseName.size() > MaxFiltersLength))
+        {
+            batches << Batch{ arguments, batch, batch, 0, 0 };
+            batch.clear();
+            length = 0;
+        }
+        batch << caseName;
+        length += caseName.size() + 1;
     }
-
-    if (numExecutorsFinished == executors.size())
+    if (!batch.isEmpty())
     {
-        emitResult();
+        batches << Batch{ arguments, batch, batch, 0, 0 };
     }
+    return batches;
 }
 
-void CargoFindTestsJob::procError(const QString& suiteName, QProcess::ProcessError err)
+void CargoRunTestsJob::scheduleBatch(const Batch& batch)
 {
-    if (killed)
+    CargoTestScheduler* scheduler = suite->scheduler();
+    if (!scheduler)
     {
+        processError = true;
         return;
     }
 
-    qCDebug(KDEV_CARGO) << "Proc error" << suiteName << err;
-    numExecutorsFinished++;
+    CargoTestProcess* process = scheduler->schedule(suite->executable().toLocalFile(), batch.arguments + batch.filters,
+                                                    batch.threads > 0 ? batch.threads : batch.cases.size());
+    process->setPriority(batch.priority);
+    runningBatches.insert(process, { batch, QSet<QString>(), QElapsedTimer() });
 
-    if (numExecutorsFinished == executors.size())
-    {
-        emitResult();
+    // The case timeout counts from the start of the process, not from when it was queued
+    connect( process, &CargoTestProcess::started, this, [this, process]() {
+        if (!runTimer.isValid())
+        {
+            runTimer.start();
+        }
+        auto running = runningBatches.find(process);
+        if (running != runningBatches.end())
+        {
+            running->progress.start();
+        }
+    });
+
+    connect( process, &CargoTestProcess::receivedStandardError, model, &OutputModel::appendLines );
+    connect( process, &CargoTestProcess::receivedStandardOutput, this, [this, process](const QStringList& lines) {
+        parseOutput(process, lines);
+    });
+    connect( process, &CargoTestProcess::finished, this, [this, process](int code) {
+        if (code != 0)
+        {
+            failed = true;
+        }
+        processFinished(process);
+    });
+    connect( process, &CargoTestProcess::failed, this, [this, process]() {
+        processError = true;
+        processFinished(process);
+    });
+
+    processes << process;
+}
+
+void CargoRunTestsJob::checkTimeouts()
+{
+    if (suiteTimeout > 0 && runTimer.isValid() && runTimer.elapsed() > suiteTimeout * 1000)
+    {
+        qCDebug(KDEV_CARGO) << "Test suite" << suite->name() << "timed out";
+        watchdog->stop();
+
+        // Processes that did not start yet are not run at all, so their cases are errors like those that did not finish
+        for (auto it = processes.begin(); it != processes.end(); )
+        {
+            CargoTestProcess* process = *it;
+            if (process && process->threads() == 0)
+            {
+                for (const auto& caseName : runningBatches.take(process).batch.cases)
+                {
+                    caseResults.insert(caseName, TestResult::Error);
+                }
+                failed = true;
+                caseFailed = true;
+                process->kill();
+                process->deleteLater();
+                it = processes.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        for (auto process : runningBatches.keys())
+        {
+            timedOut(process, true);
+        }
+        if (processes.isEmpty())
+        {
+            finish();
+        }
+        return;
+    }
+
+    if (caseTimeout <= 0)
+    {
+        return;
+    }
+
+    for (auto process : runningBatches.keys())
+    {
+        const RunningBatch& running = runningBatches[process];
+        if (running.progress.isValid() && running.progress.elapsed() > caseTimeout * 1000)
+        {
+            timedOut(process, false);
+        }
+    }
+}
+
+void CargoRunTestsJob::timedOut(CargoTestProcess* process, bool suiteTimedOut)
+{
+    const RunningBatch running = runningBatches.take(process);
+    const qint64 pid = process->pid();
+
+    QStringList unfinished;
+    for (const auto& caseName : running.batch.cases)
+    {
+        if (!running.finishedCases.contains(caseName))
+        {
+            unfinished << caseName;
+        }
+    }
+    unfinished.sort();
+
+    /*
+     * libtest runs the cases of a process in the order of their names, so with a single thread the hanging case
+     * is the first one that did not finish. With more threads, any unfinished case may hang, so they are all
+     * run again on a single thread, which finds the hanging case once it times out again.
+     */
+    QStringList hanging;
+    QString message;
+    if (suiteTimedOut)
+    {
+        hanging = unfinished;
+        unfinished.clear();
+        message = i18n("Test suite %1 did not finish in %2 seconds. Stacks of test process %3:", suite->name(), suiteTimeout, pid);
+    }
+    else if (process->threads() == 1 && !unfinished.isEmpty())
+    {
+        hanging << unfinished.takeFirst();
+        message = i18n("Test case %1 did not finish in %2 seconds. Stacks of test process %3:", hanging.first(), caseTimeout, pid);
+    }
+    else
+    {
+        message = i18n("No test case finished in %1 seconds, unfinished cases are run again one at a time. Stacks of test process %2:",
+                       caseTimeout, pid);
+    }
+
+    // The process is kept until the stacks are dumped, so that the job does not finish before
+    QPointer<CargoTestProcess> guard(process);
+    auto dump = new CargoStackDump(pid, this);
+    connect(dump, &CargoStackDump::finished, this, [this, guard, running, hanging, unfinished, message](const QString& stacks) {
+        if (!guard)
+        {
+            // The process finished after all, or the job was killed
+            return;
+        }
+
+        processes.removeOne(guard);
+        caseTimers.remove(guard);
+        guard->kill();
+        guard->deleteLater();
+
+        model->appendLine(message);
+        model->appendLines(stacks.isEmpty() ? QStringList{ i18n("The stacks could not be read.") } : stacks.split(QLatin1Char('\n')));
+
+        for (const auto& caseName : hanging)
+        {
+            caseResults.insert(caseName, TestResult::Error);
+        }
+
+        // Unfinished cases that are run again one at a time decide the outcome, unless the process hung after all of them
+        if (!hanging.isEmpty() || unfinished.isEmpty())
+        {
+            failed = true;
+        }
+        if (!hanging.isEmpty())
+        {
+            caseFailed = true;
+        }
+
+        // The remaining cases continue in a fresh process
+        if (!unfinished.isEmpty())
+        {
+            QStringList arguments = running.batch.arguments;
+            if (!arguments.contains(QStringLiteral("--exact")))
+            {
+                arguments << QStringLiteral("--exact");
+            }
+            for (Batch batch : exactBatches(arguments, unfinished))
+            {
+                batch.priority = running.batch.priority;
+                batch.threads = hanging.isEmpty() ? 1 : 0;
+                scheduleBatch(batch);
+            }
+        }
+
+        if (processes.isEmpty())
+        {
+            finish();
+        }
+    });
+    dump->start();
+}
+
+void CargoRunTestsJob::killProcesses()
+{
+    for (const auto& process : processes)
+    {
+        delete process.data();
+    }
+    processes.clear();
+    runningBatches.clear();
+}
+
+void CargoRunTestsJob::processFinished(CargoTestProcess* process)
+{
+    processes.removeOne(process);
+    caseTimers.remove(process);
+    runningBatches.remove(process);
+    process->deleteLater();
+
+    if (processes.isEmpty())
+    {
+        finish();
+    }
+}
+
+void CargoRunTestsJob::finish()
+{
+    if (killed)
+    {
+        return;
+    }
+
+    watchdog->stop();
+
+    suite->addResults(caseResults);
+    if (repeat > 1)
+    {
+        reportRepetitions();
+    }
+
+    TestResult result;
+
+    for (auto it = caseResults.constBegin(); it != caseResults.constEnd(); ++it)
+    {
+        result.testCaseResults.insert(it.key(), it.value());
+    }
+
+    if (processError)
+    {
+        setError( FailedShownError );
+        setErrorText( i18n( "Error running test command." ) );
+
+        result.suiteResult = TestResult::Error;
+        ICore::self()->testController()->notifyTestRunFinished(suite, result);
+
+        emitResult();
+        return;
+    }
+
+    if (failed) {
+        setError(FailedShownError);
+        result.suiteResult = TestResult::Failed;
+    } else {
+        result.suiteResult = TestResult::Passed;
+    }
+
+    ICore::self()->testController()->notifyTestRunFinished(suite, result);
+
+    // Only a run of the whole suite tells how long the suite takes
+    QSet<QString> failedCases;
+    for (auto it = caseResults.constBegin(); it != caseResults.constEnd(); ++it)
+    {
+        if (it.value() == TestResult::Failed)
+        {
+            failedCases.insert(it.key());
+        }
+    }
+
+    CargoTestHistory history(CargoTestHistory::fileName(suite->project()));
+    history.addRun(suite->name(), caseNames.isEmpty() && runTimer.isValid() ? runTimer.elapsed() : -1, caseTimes, failedCases);
+    if (caseNames.isEmpty() && !failed)
+    {
+        history.addPassedRun(suite->name(), startTime);
+    }
+
+    emitResult();
+}
+
+void CargoRunTestsJob::parseOutput(CargoTestProcess* process, const QStringList& lines)
+{
+    model->appendLines(lines);
+
+    // Without reported times, a case took the time since the previous result of the same process
+    if (!caseTimers.contains(process))
+    {
+        caseTimers[process].start();
+    }
+
+    for (auto& line : lines)
+    {
+        qCDebug(KDEV_CARGO) << "Received output line" << line;
+        QStringList elements = line.split(' ');
+        if ((elements.size() == 4 || elements.size() == 5) && elements[0] == QStringLiteral("test"))
+        {
+            QString testCase = elements[1];
+            TestResult::TestCaseResult result = parseResult(elements[3]);
+
+            qCDebug(KDEV_CARGO) << "Received test case result" << testCase << elements[3] << result;
+
+            // The reported time looks like "<0.015s>"
+            qint64 time = caseTimers[process].restart();
+            if (elements.size() == 5 && elements[4].startsWith(QLatin1Char('<')) && elements[4].endsWith(QLatin1String("s>")))
+            {
+                bool ok = false;
+                const double seconds = elements[4].mid(1, elements[4].size() - 3).toDouble(&ok);
+                if (ok)
+                {
+                    time = qRound64(seconds * 1000);
+                }
+            }
+            if (result == TestResult::Passed || result == TestResult::Failed)
+            {
+                caseTimes.insert(testCase, time);
+            }
+
+            if (repeat > 1)
+            {
+                if (result == TestResult::Passed || result == TestResult::Failed)
+                {
+                    repeatedTimes[testCase] << time;
+                }
+                if (result == TestResult::Passed)
+                {
+                    casePasses[testCase] += 1;
+                }
+
+                // A case fails if any of its repetitions failed
+                if (caseResults.value(testCase, TestResult::NotRun) == TestResult::Failed)
+                {
+                    result = TestResult::Failed;
+                }
+            }
+
+            auto running = runningBatches.find(process);
+            if (running != runningBatches.end())
+            {
+                running->finishedCases.insert(testCase);
+                running->progress.restart();
+            }
+
+            caseResults.insert(testCase, result);
+            setProcessedAmount( KJob::Items, processedAmount( KJob::Items ) + 1 );
+            emitPercent( processedAmount( KJob::Items ), totalAmount( KJob::Items ) );
+            if (result == TestResult::Failed)
+            {
+                caseFailed = true;
+            }
+        }
+    }
+
+    if (repeat > 1 && stopOnFailure && caseFailed)
+    {
+        stopRepeating();
+    }
+}
+
+void CargoRunTestsJob::stopRepeating()
+{
+    // The process that reported the failure is still emitting its output, so processes are only deleted later
+    for (const auto& process : processes)
+    {
+        if (process)
+        {
+            process->kill();
+            process->deleteLater();
+        }
+    }
+    processes.clear();
+    caseTimers.clear();
+    runningBatches.clear();
+    failed = true;
+    finish();
+}
+
+void CargoRunTestsJob::reportRepetitions()
+{
+    QStringList cases = repeatedTimes.keys();
+    cases.sort();
+
+    model->appendLine(i18np("Results of %1 repetition:", "Results of %1 repetitions:", repeat));
+    for (const auto& caseName : cases)
+    {
+        const QVector<qint64>& times = repeatedTimes[caseName];
+        const int passes = casePasses.value(caseName);
+
+        qint64 total = 0;
+        for (qint64 time : times)
+        {
+            total += time;
+        }
+
+        model->appendLine(i18n("%1: passed %2 of %3 runs (%4%), took %5 ms on average, from %6 to %7 ms",
+                               caseName, passes, times.size(), passes * 100 / times.size(), total / times.size(),
+                               *std::min_element(times.constBegin(), times.constEnd()),
+                               *std::max_element(times.constBegin(), times.constEnd())));
+    }
+}
+
+KJob* CargoTestSuite::launchCases(const QStringList & testCases, KDevelop::ITestSuite::TestJobVerbosity verbosity)
+{
+    return new CargoRunTestsJob(this, testCases, verbosity);
+}
+
+KJob * CargoTestSuite::launchCase(const QString& testCase, KDevelop::ITestSuite::TestJobVerbosity verbosity)
+{
+    return new CargoRunTestsJob(this, { testCase }, verbosity);
+}
+
+KJob * CargoTestSuite::launchAllCases(KDevelop::ITestSuite::TestJobVerbosity verbosity)
+{
+    return new CargoRunTestsJob(this, QStringList(), verbosity);
+}
+
+KJob* CargoTestSuite::launchRepeatedCases(const QStringList& testCases, int repeat, bool stopOnFailure)
+{
+    // The results of the repetitions are only shown in the output
+    return new CargoRunTestsJob(this, testCases, ITestSuite::Verbose, repeat, stopOnFailure);
+}
+
+QStringList CargoFindTestsJob::failedCases(ITestSuite* suite)
+{
+    auto cargoSuite = dynamic_cast<CargoTestSuite*>(suite);
+    return cargoSuite ? cargoSuite->failedCases() : QStringList();
+}
+
+KJob* CargoFindTestsJob::launchRepeatedCases(ITestSuite* suite, const QStringList& testCases, int repeat, bool stopOnFailure)
+{
+    auto cargoSuite = dynamic_cast<CargoTestSuite*>(suite);
+    return cargoSuite ? cargoSuite->launchRepeatedCases(testCases, repeat, stopOnFailure) : nullptr;
+}
+
+CargoFindTestsJob::CargoFindTestsJob(CargoPlugin* plugin, KDevelop::ProjectBaseItem* item)
+ : KJob(plugin)
+ , plugin(plugin)
+ , hasTestExecutables(false)
+ , runningReads(0)
+ , jsonListing(true)
+ , runAfterFinding(RunNothing)
+ , killed(false)
+{
+    setCapabilities( Killable );
+
+    project = item->project();
+    QString projectName = item->project()->name();
+    builddir = plugin->buildDirectory( item ).toLocalFile();
+
+    KConfigGroup config( project->projectConfiguration(), "Cargo" );
+    setMaxProcesses( config.readEntry( "Discovery Processes", 0 ) );
+    setReadExecutables( config.readEntry( "Read Test Executables", false ) );
+
+    QString title = i18n("Find tests for Cargo project %1", projectName);
+    setObjectName(title);
+}
+
+void CargoFindTestsJob::setMaxProcesses(int processes)
+{
+    maxProcesses = processes > 0 ? processes : qMax(1, QThread::idealThreadCount());
+}
+
+void CargoFindTestsJob::setReadExecutables(bool read)
+{
+    readExecutables = read;
+}
+
+void CargoFindTestsJob::setRunAfterFinding(RunAfterFinding run)
+{
+    runAfterFinding = run;
+}
+
+void CargoFindTestsJob::setTestExecutables(const QMap<QString, QString>& executables)
+{
+    testExecutables = executables;
+    hasTestExecutables = true;
+}
+
+int CargoFindTestsJob::shardCount(const QString& setting, const QString& suiteName)
+{
+    for (const auto& entry : setting.split(QLatin1Char(','), QString::SkipEmptyParts))
+    {
+        const int separator = entry.indexOf(QLatin1Char('='));
+        if (separator != -1 && entry.left(separator).trimmed() == suiteName)
+        {
+            return qMax(1, entry.mid(separator + 1).trimmed().toInt());
+        }
+    }
+    return 1;
+}
+
+CargoFindTestsJob::TestOrder CargoFindTestsJob::testOrder(const QString& setting)
+{
+    if (setting == QStringLiteral("FailedFirst"))
+    {
+        return FailedFirstOrder;
+    }
+    else if (setting == QStringLiteral("LongestFirst"))
+    {
+        return LongestFirstOrder;
+    }
+    return DefaultOrder;
+}
+
+QVector<QStringList> CargoFindTestsJob::assignShards(QStringList cases, const QHash<QString, qint64>& caseTimes, int shards)
+{
+    QVector<QStringList> shardCases(qMax(1, shards));
+    cases.sort();
+
+    if (caseTimes.isEmpty())
+    {
+        for (int i = 0; i < cases.size(); ++i)
+        {
+            shardCases[i % shardCases.size()] << cases.at(i);
+        }
+        return shardCases;
+    }
+
+    qint64 total = 0;
+    for (qint64 time : caseTimes)
+    {
+        total += time;
+    }
+    const qint64 average = total / caseTimes.size();
+
+    // Longest processing time first, which keeps the longest shard within 4/3 of the best possible
+    QVector<QPair<qint64, QString>> timedCases;
+    for (const auto& caseName : cases)
+    {
+        timedCases << qMakePair(caseTimes.value(caseName, average), caseName);
+    }
+    std::stable_sort(timedCases.begin(), timedCases.end(), [](const QPair<qint64, QString>& a, const QPair<qint64, QString>& b) {
+        return a.first > b.first;
+    });
+
+    QVector<qint64> shardTimes(shardCases.size(), 0);
+    for (const auto& timedCase : timedCases)
+    {
+        const int shard = std::min_element(shardTimes.constBegin(), shardTimes.constEnd()) - shardTimes.constBegin();
+        shardCases[shard] << timedCase.second;
+        shardTimes[shard] += timedCase.first;
+    }
+    return shardCases;
+}
+
+QString CargoFindTestsJob::suiteNameForTarget(const QString& targetName)
+{
+    // Crate names are target names with dashes replaced by underscores
+    QString suiteName = targetName;
+    return suiteName.replace(QLatin1Char('-'), QLatin1Char('_'));
+}
+
+QString CargoFindTestsJob::qualifiedSuiteName(const CargoArtifact& artifact)
+{
+    QString suiteName = suiteNameForTarget(artifact.targetName);
+    if (!artifact.packageName.isEmpty())
+    {
+        suiteName.prepend(artifact.packageName + QStringLiteral("::"));
+    }
+
+    // Libraries are built as a test harness once, whatever crate types they have
+    static const QStringList libraryKinds = {
+        QStringLiteral("lib"), QStringLiteral("rlib"), QStringLiteral("dylib"),
+        QStringLiteral("cdylib"), QStringLiteral("staticlib"), QStringLiteral("proc-macro")
+    };
+    QString kind = artifact.kinds.value(0);
+    if (libraryKinds.contains(kind))
+    {
+        kind = QStringLiteral("lib");
+    }
+    if (!kind.isEmpty())
+    {
+        suiteName += QStringLiteral(" (%1)").arg(kind);
+    }
+    return suiteName;
+}
+
+QMap<QString, QString> CargoFindTestsJob::uniqueSuiteNames(const QMap<QString, QString>& qualifiedNames)
+{
+    QHash<QString, int> crateCounts;
+    QHash<QString, int> qualifiedCounts;
+    for (const auto& qualifiedName : qualifiedNames)
+    {
+        ++crateCounts[crateName(qualifiedName)];
+        ++qualifiedCounts[qualifiedName];
+    }
+
+    QMap<QString, QString> suiteNames;
+    for (auto it = qualifiedNames.constBegin(); it != qualifiedNames.constEnd(); ++it)
+    {
+        const QString crate = crateName(it.value());
+        if (crateCounts.value(crate) == 1)
+        {
+            suiteNames.insert(it.key(), crate);
+        }
+        else if (qualifiedCounts.value(it.value()) == 1)
+        {
+            suiteNames.insert(it.key(), it.value());
+        }
+        else
+        {
+            suiteNames.insert(it.key(), QStringLiteral("%1 (%2)").arg(it.value(), QFileInfo(it.key()).fileName()));
+        }
+    }
+    return suiteNames;
+}
+
+QMap<QString, QString> CargoFindTestsJob::scanTestExecutables(bool* targetDirExists) const
+{
+    QMap<QString, QString> executables;
+    QSet<QString> fileNames;
+
+    // Without artifacts, the tests are those of whichever profile was built last
+    const QString profileDir = latestProfileDirectory(plugin->targetDirectory(project).toLocalFile());
+    *targetDirExists = !profileDir.isEmpty();
+    if (profileDir.isEmpty())
+    {
+        return executables;
+    }
+
+    // Older versions of cargo copy test executables from deps/ to the profile directory
+    for (const QString& dirName : { profileDir, profileDir + QStringLiteral("/deps") })
+    {
+        QDir testDir(dirName);
+
+        QDir::Filters filters = QDir::Files | QDir::Executable;
+        for (auto info : testDir.entryInfoList(filters))
+        {
+            /*
+             * Test executable built by cargo are named
+             * <crate_name>-<hash>, where crate_name never includes dashes
+             * but may include underscores.
+             *
+             * We thus try to split each executable named into the (crate_name, hash)
+             * pair, then ignore the hash and use only the crate name as the
+             * test suite name.
+             *
+             * Shared libraries and proc-macros in deps/ are executable too,
+             * but they have a file extension.
+             */
+
+            QStringList fileNameParts = info.fileName().split('-');
+            if (fileNameParts.size() != 2 || !info.suffix().isEmpty() || fileNames.contains(info.fileName()))
+            {
+                continue;
+            }
+            fileNames.insert(info.fileName());
+            executables.insert(info.absoluteFilePath(), fileNameParts.first());
+        }
+    }
+    return executables;
+}
+
+QMap<QString, QString> CargoFindTestsJob::loadTestExecutables() const
+{
+    const QJsonObject cached = CargoCache(CargoPlugin::dataDirectory(project) + QStringLiteral("/test-executables.json")).load();
+
+    QMap<QString, QString> executables;
+    for (auto it = cached.constBegin(); it != cached.constEnd(); ++it)
+    {
+        if (QFileInfo::exists(it.key()))
+        {
+            executables.insert(it.key(), it.value().toString());
+        }
+    }
+    return executables;
+}
+
+void CargoFindTestsJob::storeTestExecutables(const QMap<QString, QString>& executables) const
+{
+    QJsonObject data;
+    for (auto it = executables.constBegin(); it != executables.constEnd(); ++it)
+    {
+        data.insert(it.key(), it.value());
+    }
+    CargoCache(CargoPlugin::dataDirectory(project) + QStringLiteral("/test-executables.json")).store(data, {});
+}
+
+void CargoFindTestsJob::start()
+{
+    QMap<QString, QString> executables;
+    QMap<QString, QString> qualifiedNames;
+    if (hasTestExecutables)
+    {
+        // Other packages may have been built before, so their executables are still remembered
+        QMap<QString, QString> known = loadTestExecutables();
+        const QList<QString> builtNames = testExecutables.values();
+        for (auto it = known.begin(); it != known.end();)
+        {
+            // An executable of a target that was built again is left over from an older build
+            it = builtNames.contains(it.value()) ? known.erase(it) : it + 1;
+        }
+        for (auto it = testExecutables.constBegin(); it != testExecutables.constEnd(); ++it)
+        {
+            known.insert(it.key(), it.value());
+        }
+        storeTestExecutables(known);
+
+        // Names are unique among all known executables, so a suite keeps its name whichever package was built
+        const QMap<QString, QString> suiteNames = uniqueSuiteNames(known);
+        for (auto it = testExecutables.constBegin(); it != testExecutables.constEnd(); ++it)
+        {
+            executables.insert(it.key(), suiteNames.value(it.key()));
+        }
+        qualifiedNames = known;
+    }
+    else
+    {
+        qualifiedNames = loadTestExecutables();
+        if (qualifiedNames.isEmpty())
+        {
+            bool targetDirExists = false;
+            qualifiedNames = scanTestExecutables(&targetDirExists);
+            if (!targetDirExists)
+            {
+                setError( TargetsDirDoesNotExist );
+                setErrorText( i18n( "The target directory %1 has no built profile", plugin->targetDirectory( project ).toLocalFile() ) );
+                emitResult();
+                return;
+            }
+        }
+        executables = uniqueSuiteNames(qualifiedNames);
+    }
+
+    // A suite named after a crate that is now shared by several executables would run the wrong one
+    ITestController* testController = plugin->core()->testController();
+    for (auto it = executables.constBegin(); it != executables.constEnd(); ++it)
+    {
+        const QString crate = crateName(qualifiedNames.value(it.key()));
+        auto stale = it.value() == crate ? nullptr : dynamic_cast<CargoTestSuite*>(testController->findTestSuite(project, crate));
+        if (stale)
+        {
+            testController->removeTestSuite(stale);
+            delete stale;
+        }
+    }
+
+    pendingTasks.clear();
+    pendingListings.clear();
+    executableListings.clear();
+    failedExecutables.clear();
+
+    QStringList cachedSuites;
+
+    // Progress is counted in executables, which is what takes time, whether or not they share a suite
+    setTotalAmount( KJob::Files, executables.size() );
+    setProcessedAmount( KJob::Files, 0 );
+
+    for (auto it = executables.constBegin(); it != executables.constEnd(); ++it)
+    {
+        const QString executable = it.key();
+        const QString suiteName = it.value();
+        suiteExecutables[suiteName] = executable;
+
+        if (loadCachedCases(suiteName, executable))
+        {
+            cachedSuites << suiteName;
+            executableListed();
+            continue;
+        }
+
+        if (readExecutables)
+        {
+            pendingTasks.enqueue({ suiteName, executable, ListTask::ReadExecutable });
+            pendingListings[suiteName] += 1;
+            executableListings[executable] = 1;
+            continue;
+        }
+
+        pendingTasks.enqueue({ suiteName, executable, ListTask::ListAllCases });
+        pendingListings[suiteName] += 1;
+        executableListings[executable] = 1;
+    }
+
+    cachedSuites.removeDuplicates();
+
+    // Suites whose executables were all cached are complete already
+    for (const auto& suiteName : cachedSuites)
+    {
+        if (!pendingListings.contains(suiteName))
+        {
+            suiteListed(suiteName);
+        }
+    }
+
+    if (pendingTasks.isEmpty())
+    {
+        allListed();
+        return;
+    }
+
+    startNextTasks();
+}
+
+void CargoFindTestsJob::startNextTasks()
+{
+    // Starting all executables at once would stall the machine in large workspaces
+    while (!killed && !pendingTasks.isEmpty() && runningExecutors.size() + runningReads < maxProcesses)
+    {
+        const ListTask task = pendingTasks.dequeue();
+        if (task.mode == ListTask::ReadExecutable)
+        {
+            startReading(task);
+            continue;
+        }
+
+        if (task.mode == ListTask::ListAllCases && !jsonListing)
+        {
+            /*
+             * All executables are built by the same toolchain, so once one could not list its cases as JSON,
+             * the others are listed twice right away. We separately track the list of ignored test cases.
+             * This is needed for the ability to run individual ignored test cases.
+             */
+            pendingTasks.prepend({ task.suiteName, task.executable, ListTask::ListIgnoredCases });
+            pendingTasks.prepend({ task.suiteName, task.executable, ListTask::ListCases });
+            pendingListings[task.suiteName] += 1;
+            executableListings[task.executable] += 1;
+            continue;
+        }
+
+        const QString suiteName = task.suiteName;
+        const QString executable = task.executable;
+
+        qCDebug(KDEV_CARGO) << "Finding tests in executable" << executable << "in dir" << builddir << ", suite" << suiteName;
+
+        auto exec = new KDevelop::CommandExecutor( executable, this );
+
+        QStringList arguments = { QStringLiteral("--list") };
+        if (task.mode == ListTask::ListIgnoredCases)
+        {
+            arguments << QStringLiteral("--ignored");
+        }
+        else if (task.mode == ListTask::ListAllCases)
+        {
+            /*
+             * Only the JSON listing marks ignored cases. It is unstable,
+             * but test harnesses built by a stable toolchain accept it with RUSTC_BOOTSTRAP.
+             */
+            arguments << QStringLiteral("--format") << QStringLiteral("json") << QStringLiteral("-Z") << QStringLiteral("unstable-options");
+            exec->setEnvironment(QMap<QString, QString>{ { QStringLiteral("RUSTC_BOOTSTRAP"), QStringLiteral("1") } });
+        }
+        exec->setArguments(arguments);
+        exec->setWorkingDirectory(builddir);
+
+        connect(exec, &CommandExecutor::completed, this, [this, exec, task](int code){
+            taskFinished(exec, task, code == 0);
+        } );
+        connect(exec, &CommandExecutor::failed, this, [this, exec, task](QProcess::ProcessError error){
+            qCDebug(KDEV_CARGO) << "Proc error" << task.suiteName << error;
+            taskFinished(exec, task, false);
+        });
+
+        if (task.mode == ListTask::ListAllCases)
+        {
+            connect(exec, &CommandExecutor::receivedStandardOutput, this, [this, suiteName, executable](const QStringList& output) {
+                addListedCases(suiteName, executable, output);
+            });
+        }
+        else if (task.mode == ListTask::ListIgnoredCases)
+        {
+            connect(exec, &CommandExecutor::receivedStandardOutput, this, [this, suiteName, executable](const QStringList& output) {
+                addIgnoredCases(suiteName, executable, output);
+            });
+        }
+        else
+        {
+            connect(exec, &CommandExecutor::receivedStandardOutput, this, [this, suiteName, executable](const QStringList& output) {
+                addSuiteCases(suiteName, executable, output);
+            });
+        }
+
+        runningExecutors.append(exec);
+        exec->start();
+    }
+}
+
+void CargoFindTestsJob::startReading(const ListTask& task)
+{
+    qCDebug(KDEV_CARGO) << "Reading tests from executable" << task.executable << ", suite" << task.suiteName;
+
+    // Reading a large executable takes a while, so it is done in another thread
+    QSharedPointer<CargoElfTestReader> reader(new CargoElfTestReader(task.executable));
+    const Path sourceRoot(builddir);
+
+    auto watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, reader, task]() {
+        watcher->deleteLater();
+        readingFinished(task, *reader, watcher->result());
+    });
+
+    ++runningReads;
+    watcher->setFuture(QtConcurrent::run([reader, sourceRoot]() {
+        return reader->read(sourceRoot);
+    }));
+}
+
+void CargoFindTestsJob::readingFinished(const ListTask& task, const CargoElfTestReader& reader, bool success)
+{
+    if (killed)
+    {
+        return;
+    }
+
+    --runningReads;
+
+    if (!success)
+    {
+        qCDebug(KDEV_CARGO) << "Could not read tests from" << task.executable << ", listing them instead";
+
+        pendingTasks.enqueue({ task.suiteName, task.executable, ListTask::ListAllCases });
+        pendingListings[task.suiteName] += 1;
+        executableListings[task.executable] += 1;
+    }
+    else
+    {
+        readFromExecutables.insert(task.executable);
+        suiteCases[task.suiteName] << reader.cases();
+        executableCases[task.executable] << reader.cases();
+
+        if (reader.ignoredCasesKnown())
+        {
+            ignoredCases[task.suiteName] << reader.ignoredCases();
+            executableIgnoredCases[task.executable] << reader.ignoredCases();
+        }
+        else
+        {
+            // Running the executable once is still cheaper than twice
+            pendingTasks.enqueue({ task.suiteName, task.executable, ListTask::ListIgnoredCases });
+            pendingListings[task.suiteName] += 1;
+            executableListings[task.executable] += 1;
+        }
+    }
+
+    listingFinished(task, true);
+}
+
+bool CargoFindTestsJob::doKill()
+{
+    killed = true;
+    pendingTasks.clear();
+    for (auto exec : runningExecutors)
+    {
+        exec->kill();
+    }
+    return true;
+}
+
+void CargoFindTestsJob::taskFinished(CommandExecutor* exec, const ListTask& task, bool success)
+{
+    if (killed)
+    {
+        return;
+    }
+
+    runningExecutors.removeOne(exec);
+    exec->deleteLater();
+
+    qCDebug(KDEV_CARGO) << "Proc finished" << task.suiteName;
+
+    if (task.mode == ListTask::ListAllCases && !jsonListedExecutables.contains(task.executable))
+    {
+        if (success)
+        {
+            // Older test harnesses ignore the format when listing, so only the ignored cases are missing
+            pendingTasks.enqueue({ task.suiteName, task.executable, ListTask::ListIgnoredCases });
+            pendingListings[task.suiteName] += 1;
+            executableListings[task.executable] += 1;
+        }
+        else
+        {
+            qCDebug(KDEV_CARGO) << "Listing as JSON is not supported by" << task.executable;
+
+            jsonListing = false;
+            pendingTasks.enqueue({ task.suiteName, task.executable, ListTask::ListCases });
+            pendingTasks.enqueue({ task.suiteName, task.executable, ListTask::ListIgnoredCases });
+            pendingListings[task.suiteName] += 2;
+            executableListings[task.executable] += 2;
+        }
+        success = true;
+    }
+
+    listingFinished(task, success);
+}
+
+void CargoFindTestsJob::listingFinished(const ListTask& task, bool success)
+{
+    if (!success)
+    {
+        failedExecutables.insert(task.executable);
+    }
+    if (--executableListings[task.executable] == 0)
+    {
+        if (!failedExecutables.contains(task.executable))
+        {
+            storeCachedCases(task.executable);
+        }
+        executableListed();
+    }
+
+    // A suite is only complete once both its cases and its ignored cases are known
+    if (--pendingListings[task.suiteName] == 0)
+    {
+        suiteListed(task.suiteName);
+    }
+
+    if (runningExecutors.isEmpty() && runningReads == 0 && pendingTasks.isEmpty())
+    {
+        allListed();
+        return;
+    }
+
+    startNextTasks();
+}
+
+void CargoFindTestsJob::suiteListed(const QString& suiteName)
+{
+    if (suiteCases.contains(suiteName))
+    {
+        // The lists are only needed until the suite's tree is built
+        CargoTestCaseTree cases;
+        for (const auto& caseName : suiteCases.take(suiteName))
+        {
+            cases.addCase(caseName);
+        }
+        for (const auto& caseName : ignoredCases.take(suiteName))
+        {
+            cases.addIgnoredCase(caseName);
+        }
+        cases.squeeze();
+        const Path executable(suiteExecutables.value(suiteName));
+
+        /*
+         * Adding a suite replaces the one with the same name, which resets it in the test view,
+         * so a suite is only replaced when it changed.
+         */
+        ITestController* testController = plugin->core()->testController();
+        auto existing = dynamic_cast<CargoTestSuite*>(testController->findTestSuite(project, suiteName));
+        if (!existing || existing->executable() != executable
+            || existing->caseTree() != cases)
+        {
+            CargoTestSuite* suite = new CargoTestSuite(suiteName, executable, cases, project, plugin->testScheduler());
+            if (existing)
+            {
+                // Failures of cases that still exist can be run again after the suite changed
+                suite->addResults(existing->lastResults());
+            }
+            testController->addTestSuite(suite);
+        }
+        else
+        {
+            qCDebug(KDEV_CARGO) << "Test suite" << suiteName << "did not change";
+        }
+    }
+}
+
+void CargoFindTestsJob::executableListed()
+{
+    setProcessedAmount( KJob::Files, processedAmount( KJob::Files ) + 1 );
+    emitPercent( processedAmount( KJob::Files ), totalAmount( KJob::Files ) );
+}
+
+void CargoFindTestsJob::allListed()
+{
+    CargoDepInfoIndex* index = plugin->depInfoIndex(project);
+    if (index)
+    {
+        index->update(suiteExecutables.values());
+    }
+
+    if (runAfterFinding == RunAllSuites)
+    {
+        /*
+         * Every job is started right away, so all of their processes wait in the scheduler together,
+         * and each job only waits for its own. The test view starts its jobs one after another instead.
+         */
+        ITestController* testController = plugin->core()->testController();
+        for (const auto& suiteName : suiteExecutables.keys())
+        {
+            ITestSuite* suite = testController->findTestSuite(project, suiteName);
+            if (suite)
+            {
+                plugin->core()->runController()->registerJob(suite->launchAllCases(ITestSuite::Silent));
+            }
+        }
+    }
+    else if (runAfterFinding == RunAffectedSuites && index)
+    {
+        // A suite is affected if it did not pass since its executable or any of its sources changed
+        const CargoTestHistory history(CargoTestHistory::fileName(project));
+        QHash<QString, QDateTime> lastPassed;
+        for (auto it = suiteExecutables.constBegin(); it != suiteExecutables.constEnd(); ++it)
+        {
+            lastPassed.insert(it.value(), history.lastPassed(it.key()));
+        }
+        const QSet<QString> affected = index->affectedExecutables(lastPassed);
+
+        ITestController* testController = plugin->core()->testController();
+        for (auto it = suiteExecutables.constBegin(); it != suiteExecutables.constEnd(); ++it)
+        {
+            ITestSuite* suite = testController->findTestSuite(project, it.key());
+            if (suite && affected.contains(it.value()))
+            {
+                qCDebug(KDEV_CARGO) << "Running affected test suite" << it.key();
+                plugin->core()->runController()->registerJob(suite->launchAllCases(ITestSuite::Silent));
+            }
+        }
+    }
+    else if (runAfterFinding == RunFailedCases)
+    {
+        // Only the suites found by this job, whose executables were just built
+        ITestController* testController = plugin->core()->testController();
+        for (const auto& suiteName : suiteExecutables.keys())
+        {
+            auto suite = dynamic_cast<CargoTestSuite*>(testController->findTestSuite(project, suiteName));
+            const QStringList cases = suite ? suite->failedCases() : QStringList();
+            if (!cases.isEmpty())
+            {
+                qCDebug(KDEV_CARGO) << "Running failed cases of test suite" << suiteName << cases;
+                plugin->core()->runController()->registerJob(suite->launchCases(cases, ITestSuite::Silent));
+            }
+        }
+    }
+
+    emitResult();
+}
+
+QString CargoFindTestsJob::cacheFileName(const QString& executable) const
+{
+    // Executable names include a hash of the target, so they are unique within the target directory
+    return CargoPlugin::dataDirectory(project) + QStringLiteral("/tests/") + QFileInfo(executable).fileName() + QStringLiteral(".json");
+}
+
+bool CargoFindTestsJob::loadCachedCases(const QString& suiteName, const QString& executable)
+{
+    const QJsonObject cached = CargoCache(cacheFileName(executable)).load();
+    const QJsonValue read = cached.value(QStringLiteral("read"));
+    if (cached.isEmpty() || !read.isBool() || (read.toBool() && !readExecutables))
+    {
+        // Cases read from the executable are not trusted once reading is turned off, nor are those of caches that do not tell
+        return false;
+    }
+
+    qCDebug(KDEV_CARGO) << "Using cached cases of" << executable;
+
+    // Like after listing, the suite exists even if the executable has no test cases
+    QStringList& cases = suiteCases[suiteName];
+    for (const auto& testCase : cached.value(QStringLiteral("cases")).toArray())
+    {
+        cases << testCase.toString();
+    }
+    QStringList& ignored = ignoredCases[suiteName];
+    for (const auto& testCase : cached.value(QStringLiteral("ignored")).toArray())
+    {
+        ignored << testCase.toString();
+    }
+    return true;
+}
+
+void CargoFindTestsJob::storeCachedCases(const QString& executable)
+{
+    QJsonObject data;
+    data.insert(QStringLiteral("cases"), QJsonArray::fromStringList(executableCases.take(executable)));
+    data.insert(QStringLiteral("ignored"), QJsonArray::fromStringList(executableIgnoredCases.take(executable)));
+    data.insert(QStringLiteral("read"), readFromExecutables.remove(executable));
+    // Executables are often hundreds of megabytes, too much to hash on the GUI thread after every build
+    CargoCache(cacheFileName(executable)).store(data, { executable }, CargoCache::CompareTimestamps);
+}
+
+void CargoFindTestsJob::addListedCases(const QString& suiteName, const QString& executable, const QStringList& lines)
+{
+    qCDebug(KDEV_CARGO) << "Received listing for suite" << suiteName;
+
+    QStringList plainLines;
+    for (const auto& line : lines)
+    {
+        if (!line.startsWith(QLatin1Char('{')))
+        {
+            plainLines << line;
+            continue;
+        }
+
+        const QJsonObject message = QJsonDocument::fromJson(line.toUtf8()).object();
+        const QString type = message.value(QStringLiteral("type")).toString();
+        const QString event = message.value(QStringLiteral("event")).toString();
+        if (type == QLatin1String("suite") && event == QLatin1String("discovery"))
+        {
+            // Like after listing, the suite exists even if the executable has no test cases
+            jsonListedExecutables.insert(executable);
+            if (!suiteCases.contains(suiteName))
+            {
+                suiteCases.insert(suiteName, QStringList());
+            }
+        }
+        else if (type == QLatin1String("test") && event == QLatin1String("discovered"))
+        {
+            const QString name = message.value(QStringLiteral("name")).toString();
+            suiteCases[suiteName] << name;
+            executableCases[executable] << name;
+
+            if (message.value(QStringLiteral("ignore")).toBool())
+            {
+                ignoredCases[suiteName] << name;
+                executableIgnoredCases[executable] << name;
+            }
+        }
+    }
+
+    // Test harnesses that do not list as JSON print the usual listing
+    if (!plainLines.isEmpty())
+    {
+        addSuiteCases(suiteName, executable, plainLines);
     }
 }
 
-void CargoFindTestsJob::addSuiteCases(const QString& suiteName, const QStringList& lines)
+void CargoFindTestsJob::addSuiteCases(const QString& suiteName, const QString& executable, const QStringList& lines)
 {
     qCDebug(KDEV_CARGO) << "Received lines for suite" << suiteName;
 
@@ -460,11 +1962,12 @@ void CargoFindTestsJob::addSuiteCases(const QString& suiteName, const QStringLis
             qCDebug(KDEV_CARGO) << "Adding case" << elements[0] << "to suite" << suiteName;
 
             suiteCases[suiteName] << elements[0];
+            executableCases[executable] << elements[0];
         }
     }
 }
 
-void CargoFindTestsJob::addIgnoredCases(const QString& suiteName, const QStringList& lines)
+void CargoFindTestsJob::addIgnoredCases(const QString& suiteName, const QString& executable, const QStringList& lines)
 {
     qCDebug(KDEV_CARGO) << "Received ignored lines for suite" << suiteName;
 
@@ -481,6 +1984,7 @@ void CargoFindTestsJob::addIgnoredCases(const QString& suiteName, const QStringL
             qCDebug(KDEV_CARGO) << "Adding ignored case" << elements[0] << "to suite" << suiteName;
 
             ignoredCases[suiteName] << elements[0];
+            executableIgnoredCases[executable] << elements[0];
         }
     }
 }
@@ -24,14 +24,21 @@
 #define CARGOFINDTESTSJOB_H
 
 #include <outputview/outputjob.h>
+#include <QMap>
 #include <QProcess>
+#include <QQueue>
+#include <QSet>
 #include <QUrl>
+#include <QVector>
 
+struct CargoArtifact;
+class CargoElfTestReader;
 class CargoPlugin;
 namespace KDevelop
 {
 class ProjectBaseItem;
 class CommandExecutor;
+class ITestSuite;
 class OutputModel;
 class IProject;
 }
@@ -46,26 +53,173 @@ public:
         TargetsDirDoesNotExist = UserDefinedError,
     };
 
+    /// The order in which test processes are started, using the recorded CargoTestHistory
+    enum TestOrder {
+        /// Suites in the order they are run, and cases in the order of the harness
+        DefaultOrder,
+        /// Cases that failed in their last run first, then cases that failed before, then all others
+        FailedFirstOrder,
+        /// Processes expected to take the longest first, and shards packed to take about the same time
+        LongestFirstOrder
+    };
+
     CargoFindTestsJob(CargoPlugin*, KDevelop::ProjectBaseItem*);
 
+    /// Run at most @p processes test executables at the same time, 0 means one per available core
+    void setMaxProcesses(int processes);
+
+    /**
+     * Read test cases directly from test executables where possible, instead of running them with --list.
+     *
+     * Executables that cannot be read are still listed by running them.
+     */
+    void setReadExecutables(bool read);
+
+    /**
+     * Look for tests only in @p executables, which map test executables to their qualified suite names.
+     *
+     * These are usually the test artifacts reported by the build that just finished.
+     * Without them, the job uses the test executables it found the last time,
+     * or looks for them in the target directory.
+     */
+    void setTestExecutables(const QMap<QString, QString>& executables);
+
+    /// What is run once all suites are found
+    enum RunAfterFinding {
+        RunNothing,
+        /// Every suite that was found, with the processes of all suites queued at once
+        RunAllSuites,
+        /// The suites that are affected by changes since they last passed, see CargoDepInfoIndex::affectedExecutables()
+        RunAffectedSuites,
+        /// The cases of each suite that failed the last time they were run
+        RunFailedCases
+    };
+
+    void setRunAfterFinding(RunAfterFinding run);
+
+    /// @return the suite name for tests of target @p targetName, which is the crate name
+    static QString suiteNameForTarget(const QString& targetName);
+
+    /**
+     * @return the suite name for tests of @p artifact, "package::crate (kind)",
+     *         which tells apart the library and binary of a package, and same-named targets of workspace members
+     */
+    static QString qualifiedSuiteName(const CargoArtifact& artifact);
+
+    /**
+     * Suites are named after their crates, unless the crate names of several executables are the same.
+     * Those keep their qualified names, or if even these are the same, get the executable file name as well.
+     *
+     * @param qualifiedNames maps test executables to their qualified suite names, or to crate names if nothing else is known
+     * @return the same executables mapped to unique suite names
+     */
+    static QMap<QString, QString> uniqueSuiteNames(const QMap<QString, QString>& qualifiedNames);
+
+    /**
+     * @return the number of shards a run of suite @p suiteName is split into
+     *
+     * @param setting the "Test Shards" project setting, a comma separated list of suite=count entries
+     */
+    static int shardCount(const QString& setting, const QString& suiteName);
+
+    /// @return the order set by @p setting, the "Test Order" project setting
+    static TestOrder testOrder(const QString& setting);
+
+    /**
+     * Splits @p cases into @p shards.
+     *
+     * Without @p caseTimes, the sorted cases are assigned round-robin. Otherwise the longest cases
+     * are assigned first, each to the shard with the least total time so far.
+     * Cases without a time count as taking the average time.
+     */
+    static QVector<QStringList> assignShards(QStringList cases, const QHash<QString, qint64>& caseTimes, int shards);
+
+    /// @return the cases of @p suite that failed the last time they were run, if it is a Cargo test suite
+    static QStringList failedCases(KDevelop::ITestSuite* suite);
+
+    /**
+     * @return a job that runs @p testCases of @p suite @p repeat times, in parallel, and shows the pass rate
+     *         and the spread of times of each case, or nullptr if @p suite is not a Cargo test suite
+     *
+     * @param stopOnFailure stop all repetitions once a case failed
+     */
+    static KJob* launchRepeatedCases(KDevelop::ITestSuite* suite, const QStringList& testCases, int repeat, bool stopOnFailure);
+
     void start() override;
     bool doKill() override;
 
-private slots:
-    void procFinished(const QString& suiteName, const QString& executable, int);
-    void procError(const QString& suiteName, QProcess::ProcessError);
 private:
-    void addSuiteCases(const QString& suiteName, const QStringList& lines);
-    void addIgnoredCases(const QString& suiteName, const QStringList& lines);
+    /// Listing the cases of a test executable, or reading them from the executable
+    struct ListTask
+    {
+        enum Mode
+        {
+            /// Lists the cases and marks ignored ones in a single pass, if the test harness supports it
+            ListAllCases,
+            ListCases,
+            ListIgnoredCases,
+            ReadExecutable
+        };
+
+        QString suiteName;
+        QString executable;
+        Mode mode;
+    };
+
+    QMap<QString, QString> scanTestExecutables(bool* targetDirExists) const;
+    QMap<QString, QString> loadTestExecutables() const;
+    void storeTestExecutables(const QMap<QString, QString>& executables) const;
+
+    void startNextTasks();
+    void startReading(const ListTask& task);
+    void readingFinished(const ListTask& task, const CargoElfTestReader& reader, bool success);
+    void taskFinished(KDevelop::CommandExecutor* exec, const ListTask& task, bool success);
+    void listingFinished(const ListTask& task, bool success);
+    void suiteListed(const QString& suiteName);
+    void executableListed();
+    void allListed();
+    void addListedCases(const QString& suiteName, const QString& executable, const QStringList& lines);
+    void addSuiteCases(const QString& suiteName, const QString& executable, const QStringList& lines);
+    void addIgnoredCases(const QString& suiteName, const QString& executable, const QStringList& lines);
+
+    /**
+     * Cases of test executables that were not rebuilt since they were last listed
+     * are read from a cache in the target directory.
+     *
+     * @return true if the cases of @p executable were found in the cache and added to @p suiteName
+     */
+    bool loadCachedCases(const QString& suiteName, const QString& executable);
+    void storeCachedCases(const QString& executable);
+    QString cacheFileName(const QString& executable) const;
 
     CargoPlugin* plugin;
     KDevelop::IProject* project;
     QString builddir;
 
-    QList<KDevelop::CommandExecutor*> executors;
-    int numExecutorsFinished;
+    int maxProcesses;
+    bool readExecutables;
+    QMap<QString, QString> testExecutables;
+    bool hasTestExecutables;
+    QQueue<ListTask> pendingTasks;
+    QList<KDevelop::CommandExecutor*> runningExecutors;
+    int runningReads;
+    bool jsonListing;
+    QSet<QString> jsonListedExecutables;
+    RunAfterFinding runAfterFinding;
+
+    /// Number of listings that are not finished yet, for each suite
+    QHash<QString, int> pendingListings;
     QHash<QString, QStringList> suiteCases;
     QHash<QString, QStringList> ignoredCases;
+    QHash<QString, QString> suiteExecutables;
+
+    /// Listings that are not finished yet, and their results so far, for each executable
+    QHash<QString, int> executableListings;
+    QHash<QString, QStringList> executableCases;
+    QHash<QString, QStringList> executableIgnoredCases;
+    QSet<QString> failedExecutables;
+    /// Executables whose cases were read from the executable rather than listed by running it
+    QSet<QString> readFromExecutables;
 
     bool killed;
     bool enabled;
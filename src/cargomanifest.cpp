@@ -0,0 +1,157 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargomanifest.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+
+using namespace KDevelop;
+
+namespace CargoManifest
+{
+
+QString packageName(const Path& manifest)
+{
+    QFile file(manifest.toLocalFile());
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return QString();
+    }
+
+    // Only plain `name = "..."` keys directly in the [package] table are recognized
+    bool inPackage = false;
+    while (!file.atEnd())
+    {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.startsWith(QLatin1Char('[')))
+        {
+            inPackage = (line == QStringLiteral("[package]"));
+            continue;
+        }
+        if (!inPackage || !line.startsWith(QStringLiteral("name")))
+        {
+            continue;
+        }
+
+        const int equals = line.indexOf(QLatin1Char('='));
+        if (equals < 0 || line.midRef(4, equals - 4).trimmed().size() != 0)
+        {
+            continue;
+        }
+
+        const QString value = line.mid(equals + 1).trimmed();
+        const QChar quote = value.isEmpty() ? QChar() : value.at(0);
+        if (quote == QLatin1Char('"') || quote == QLatin1Char('\''))
+        {
+            const int end = value.indexOf(quote, 1);
+            if (end > 0)
+            {
+                return value.mid(1, end - 1);
+            }
+        }
+    }
+    return QString();
+}
+
+Path findPackageManifest(const Path& path, const Path& root)
+{
+    Path dir = QFileInfo(path.toLocalFile()).isDir() ? path : path.parent();
+    while (dir.isValid() && (dir == root || root.isParentOf(dir)))
+    {
+        const Path manifest(dir, QStringLiteral("Cargo.toml"));
+        if (QFileInfo::exists(manifest.toLocalFile()) && !packageName(manifest).isEmpty())
+        {
+            return manifest;
+        }
+        if (dir == root)
+        {
+            break;
+        }
+        dir = dir.parent();
+    }
+    return Path();
+}
+
+QStringList targetArguments(const Path& path, const Path& packageDir, const QString& package)
+{
+    const QStringList segments = packageDir.relativePath(path).split(QLatin1Char('/'), QString::SkipEmptyParts);
+    if (segments.size() < 2)
+    {
+        return {};
+    }
+
+    const QString& dir = segments.at(0);
+    if (dir == QStringLiteral("src"))
+    {
+        if (segments.size() == 2 && segments.at(1) == QStringLiteral("lib.rs"))
+        {
+            return { QStringLiteral("--lib") };
+        }
+        else if (segments.size() == 2 && segments.at(1) == QStringLiteral("main.rs"))
+        {
+            return { QStringLiteral("--bin"), package };
+        }
+        else if (segments.size() >= 3 && segments.at(1) == QStringLiteral("bin"))
+        {
+            // Either src/bin/<name>.rs or src/bin/<name>/main.rs and its modules
+            QString name = segments.at(2);
+            if (segments.size() == 3)
+            {
+                if (!name.endsWith(QStringLiteral(".rs")))
+                {
+                    return QFileInfo(path.toLocalFile()).isDir() ? QStringList{ QStringLiteral("--bin"), name } : QStringList();
+                }
+                name.chop(3);
+            }
+            return { QStringLiteral("--bin"), name };
+        }
+        return {};
+    }
+
+    static const QHash<QString, QString> options = {
+        { QStringLiteral("tests"), QStringLiteral("--test") },
+        { QStringLiteral("examples"), QStringLiteral("--example") },
+        { QStringLiteral("benches"), QStringLiteral("--bench") },
+    };
+
+    const QString option = options.value(dir);
+    if (option.isEmpty())
+    {
+        return {};
+    }
+
+    // Either <dir>/<name>.rs, or <dir>/<name>/ with a main.rs and modules
+    QString name = segments.at(1);
+    if (segments.size() == 2)
+    {
+        if (!name.endsWith(QStringLiteral(".rs")))
+        {
+            return QFileInfo(path.toLocalFile()).isDir() ? QStringList{ option, name } : QStringList();
+        }
+        name.chop(3);
+    }
+    return { option, name };
+}
+
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOMANIFEST_H
+#define CARGOMANIFEST_H
+
+#include <util/path.h>
+
+#include <QStringList>
+
+/**
+ * Minimal reading of Cargo.toml manifests, enough to find the package that owns a file.
+ */
+namespace CargoManifest
+{
+
+/**
+ * @return the name in the [package] section of @p manifest,
+ *         or an empty string for virtual workspace manifests and unreadable files
+ */
+QString packageName(const KDevelop::Path& manifest);
+
+/**
+ * Finds the manifest of the package that contains @p path,
+ * looking in its directory and its parents, but not above @p root.
+ *
+ * @return the path to Cargo.toml, or an invalid path if no package contains @p path
+ */
+KDevelop::Path findPackageManifest(const KDevelop::Path& path, const KDevelop::Path& root);
+
+/**
+ * Guesses the target of package @p package in @p packageDir that @p path belongs to,
+ * from cargo's conventional source layout: src/lib.rs, src/main.rs, src/bin/, tests/, examples/ and benches/.
+ *
+ * @return cargo arguments that select the target, such as "--bin name",
+ *         or an empty list if @p path is not the root of a target
+ */
+QStringList targetArguments(const KDevelop::Path& path, const KDevelop::Path& packageDir, const QString& package);
+
+}
+
+#endif
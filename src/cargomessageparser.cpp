@@ -0,0 +1,307 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargomessageparser.h"
+
+#include <KLocalizedString>
+
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "debug.h"
+
+using namespace KDevelop;
+
+namespace
+{
+
+FilteredItem::FilteredOutputItemType itemTypeForLevel(const QString& level)
+{
+    // Internal compiler errors have the level "error: internal compiler error"
+    if (level.startsWith(QStringLiteral("error")))
+    {
+        return FilteredItem::ErrorItem;
+    }
+    else if (level == QStringLiteral("warning"))
+    {
+        return FilteredItem::WarningItem;
+    }
+    return FilteredItem::InformationItem;
+}
+
+/**
+ * Spans inside macro expansions point to pseudo-files like "<println macros>",
+ * so we follow the expansion chain back to the macro invocation in real source code.
+ */
+QJsonObject sourceSpan(QJsonObject span)
+{
+    while (span.value(QStringLiteral("file_name")).toString().startsWith(QLatin1Char('<')))
+    {
+        const QJsonObject expansion = span.value(QStringLiteral("expansion")).toObject();
+        if (expansion.isEmpty())
+        {
+            break;
+        }
+        span = expansion.value(QStringLiteral("span")).toObject();
+    }
+    return span;
+}
+
+/**
+ * Package IDs are "name version (source)" in older versions of cargo,
+ * and "source#name@version" or "source#version" since the package ID spec is used.
+ * Without a name in the fragment, the package is named after the last segment of its source.
+ */
+QString packageNameFromId(const QString& id)
+{
+    const int fragment = id.lastIndexOf(QLatin1Char('#'));
+    if (fragment == -1)
+    {
+        return id.section(QLatin1Char(' '), 0, 0);
+    }
+
+    const QString nameAndVersion = id.mid(fragment + 1);
+    const int version = nameAndVersion.indexOf(QLatin1Char('@'));
+    if (version != -1)
+    {
+        return nameAndVersion.left(version);
+    }
+    return id.left(fragment).section(QLatin1Char('/'), -1);
+}
+
+}
+
+CargoMessageParser::CargoMessageParser(const Path& buildDir)
+ : m_buildDir(buildDir)
+{
+}
+
+QVector<FilteredItem> CargoMessageParser::feed(const QByteArray& chunk)
+{
+    QVector<FilteredItem> items;
+    m_buffer += chunk;
+
+    int start = 0;
+    int end;
+    while ((end = m_buffer.indexOf('\n', start)) != -1)
+    {
+        items += parseLine(m_buffer.mid(start, end - start));
+        start = end + 1;
+    }
+    m_buffer.remove(0, start);
+
+    return items;
+}
+
+QVector<FilteredItem> CargoMessageParser::flush()
+{
+    if (m_buffer.isEmpty())
+    {
+        return {};
+    }
+
+    const QByteArray line = m_buffer;
+    m_buffer.clear();
+    return parseLine(line);
+}
+
+QVector<FilteredItem> CargoMessageParser::parseLine(const QByteArray& line)
+{
+    QByteArray data = line;
+    if (data.endsWith('\r'))
+    {
+        data.chop(1);
+    }
+
+    QVector<FilteredItem> items;
+
+    if (data.startsWith('{'))
+    {
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(data, &error);
+        const QJsonObject record = document.object();
+        const QString reason = record.value(QStringLiteral("reason")).toString();
+
+        if (error.error == QJsonParseError::NoError && !reason.isEmpty())
+        {
+            if (reason == QStringLiteral("compiler-message"))
+            {
+                parseCompilerMessage(record.value(QStringLiteral("message")).toObject(), &items);
+            }
+            else if (reason == QStringLiteral("compiler-artifact"))
+            {
+                parseCompilerArtifact(record, &items);
+            }
+            else if (reason == QStringLiteral("build-finished"))
+            {
+                const bool success = record.value(QStringLiteral("success")).toBool();
+                items << FilteredItem(success ? i18n("Build finished successfully") : i18n("Build failed"),
+                                      FilteredItem::ActionItem);
+            }
+            else
+            {
+                qCDebug(KDEV_CARGO) << "Skipping cargo message" << reason;
+            }
+            return items;
+        }
+    }
+
+    items << FilteredItem(QString::fromLocal8Bit(data));
+    return items;
+}
+
+QVector<CargoDiagnostic> CargoMessageParser::takeDiagnostics()
+{
+    QVector<CargoDiagnostic> diagnostics;
+    diagnostics.swap(m_diagnostics);
+    return diagnostics;
+}
+
+QVector<CargoArtifact> CargoMessageParser::takeArtifacts()
+{
+    QVector<CargoArtifact> artifacts;
+    artifacts.swap(m_artifacts);
+    return artifacts;
+}
+
+void CargoMessageParser::parseCompilerMessage(const QJsonObject& message, QVector<FilteredItem>* items)
+{
+    const QString level = message.value(QStringLiteral("level")).toString();
+
+    QJsonObject primarySpan;
+    for (const auto& value : message.value(QStringLiteral("spans")).toArray())
+    {
+        const QJsonObject span = value.toObject();
+        if (span.value(QStringLiteral("is_primary")).toBool())
+        {
+            primarySpan = sourceSpan(span);
+            break;
+        }
+    }
+
+    QUrl url;
+    int lineNo = -1;
+    int columnNo = -1;
+    CargoDiagnostic diagnostic;
+    if (!primarySpan.isEmpty())
+    {
+        const QString fileName = primarySpan.value(QStringLiteral("file_name")).toString();
+
+        // Relative file names are relative to the workspace root, which is where cargo runs rustc
+        diagnostic.file = QDir::isAbsolutePath(fileName) ? Path(fileName) : Path(m_buildDir, fileName);
+        url = diagnostic.file.toUrl();
+
+        /*
+         * Cargo counts lines and columns from 1,
+         * but KDevelop internally counts from 0.
+         */
+        lineNo = primarySpan.value(QStringLiteral("line_start")).toInt() - 1;
+        columnNo = primarySpan.value(QStringLiteral("column_start")).toInt() - 1;
+
+        diagnostic.line = lineNo;
+        diagnostic.column = columnNo;
+        diagnostic.endLine = primarySpan.value(QStringLiteral("line_end")).toInt(lineNo + 1) - 1;
+        diagnostic.endColumn = primarySpan.value(QStringLiteral("column_end")).toInt(columnNo + 1) - 1;
+    }
+
+    const QString text = message.value(QStringLiteral("message")).toString();
+    QString rendered = message.value(QStringLiteral("rendered")).toString();
+    if (rendered.isEmpty())
+    {
+        rendered = QStringLiteral("%1: %2").arg(level, text);
+    }
+
+    if (url.isValid())
+    {
+        diagnostic.level = level;
+        diagnostic.message = text;
+        diagnostic.rendered = rendered;
+        m_diagnostics << diagnostic;
+    }
+
+    QStringList lines = rendered.split(QLatin1Char('\n'));
+    while (!lines.isEmpty() && lines.last().isEmpty())
+    {
+        lines.removeLast();
+    }
+
+    /*
+     * The first line carries the severity of the diagnostic,
+     * the rest are source snippets, notes and suggestions about it.
+     * All of them lead to the primary span when activated.
+     */
+    bool first = true;
+    for (const auto& line : lines)
+    {
+        FilteredItem item(line, first ? itemTypeForLevel(level) : FilteredItem::InformationItem);
+        if (url.isValid())
+        {
+            item.isActivatable = true;
+            item.url = url;
+            item.lineNo = lineNo;
+            item.columnNo = columnNo;
+        }
+        *items << item;
+        first = false;
+    }
+}
+
+void CargoMessageParser::parseCompilerArtifact(const QJsonObject& artifact, QVector<FilteredItem>* items)
+{
+    const QJsonObject target = artifact.value(QStringLiteral("target")).toObject();
+
+    CargoArtifact built;
+    built.targetName = target.value(QStringLiteral("name")).toString();
+    for (const auto& kind : target.value(QStringLiteral("kind")).toArray())
+    {
+        built.kinds << kind.toString();
+    }
+    built.packageName = packageNameFromId(artifact.value(QStringLiteral("package_id")).toString());
+    built.test = artifact.value(QStringLiteral("profile")).toObject().value(QStringLiteral("test")).toBool();
+    built.fresh = artifact.value(QStringLiteral("fresh")).toBool();
+
+    // Libraries and build scripts have a null executable
+    const QString executable = artifact.value(QStringLiteral("executable")).toString();
+    if (!executable.isEmpty())
+    {
+        built.executable = Path(executable);
+    }
+    m_artifacts << built;
+
+    // Fresh artifacts were not rebuilt, listing them would only add noise
+    if (built.fresh)
+    {
+        return;
+    }
+
+    QStringList kinds = built.kinds;
+    if (built.test)
+    {
+        kinds << QStringLiteral("test");
+    }
+
+    items->append(FilteredItem(i18nc("<target name> (<target kinds>)", "       Built %1 (%2)",
+                                     built.targetName, kinds.join(QStringLiteral(", "))),
+                               FilteredItem::ActionItem));
+}
@@ -0,0 +1,129 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOMESSAGEPARSER_H
+#define CARGOMESSAGEPARSER_H
+
+#include <outputview/filtereditem.h>
+#include <util/path.h>
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QStringList>
+#include <QVector>
+
+class QJsonObject;
+
+/**
+ * A compiler diagnostic with a location in source code, as reported by a compiler-message.
+ * Lines and columns are counted from 0, like everywhere else in KDevelop.
+ */
+struct CargoDiagnostic
+{
+    QString level;
+    QString message;
+    QString rendered;
+    KDevelop::Path file;
+    int line = -1;
+    int column = -1;
+    int endLine = -1;
+    int endColumn = -1;
+};
+
+Q_DECLARE_METATYPE(CargoDiagnostic)
+
+/**
+ * A target built by cargo, as reported by a compiler-artifact message.
+ */
+struct CargoArtifact
+{
+    QString targetName;
+    QStringList kinds;
+
+    /// The package the target belongs to, empty if cargo did not report it
+    QString packageName;
+
+    /// Whether the target was built as a test harness, by `cargo test` or `cargo bench`
+    bool test = false;
+
+    /// Whether the target was up to date and not rebuilt
+    bool fresh = false;
+
+    /// The executable built for the target, invalid for libraries
+    KDevelop::Path executable;
+};
+
+Q_DECLARE_METATYPE(CargoArtifact)
+
+/**
+ * Incremental parser for the output of cargo commands run with --message-format=json.
+ *
+ * Every line of standard output is either a JSON message or plain text,
+ * such as the output of a build script or of the program started by `cargo run`.
+ * Messages are converted to output items with exact locations,
+ * while plain text lines are passed through unclassified (as FilteredItem::InvalidItem).
+ */
+class CargoMessageParser
+{
+public:
+    explicit CargoMessageParser(const KDevelop::Path& buildDir);
+
+    /**
+     * Consumes a chunk of standard output, which does not have to end at a line boundary.
+     * Only the unterminated last line is kept until the next call.
+     *
+     * @return output items for all the lines completed by this chunk
+     */
+    QVector<KDevelop::FilteredItem> feed(const QByteArray& chunk);
+
+    /**
+     * Parses the unterminated last line, if any.
+     * Call this once the process has finished.
+     */
+    QVector<KDevelop::FilteredItem> flush();
+
+    /**
+     * Converts a single line of output to output items.
+     * One JSON message can produce several items, or none at all.
+     */
+    QVector<KDevelop::FilteredItem> parseLine(const QByteArray& line);
+
+    /**
+     * Returns the diagnostics parsed since the last call, in the order cargo reported them.
+     * Messages without a location in source code, like "aborting due to previous error", are not included.
+     */
+    QVector<CargoDiagnostic> takeDiagnostics();
+
+    /// Returns the artifacts parsed since the last call, including fresh ones
+    QVector<CargoArtifact> takeArtifacts();
+
+private:
+    void parseCompilerMessage(const QJsonObject& message, QVector<KDevelop::FilteredItem>* items);
+    void parseCompilerArtifact(const QJsonObject& artifact, QVector<KDevelop::FilteredItem>* items);
+
+    KDevelop::Path m_buildDir;
+    QByteArray m_buffer;
+    QVector<CargoDiagnostic> m_diagnostics;
+    QVector<CargoArtifact> m_artifacts;
+};
+
+#endif
@@ -0,0 +1,226 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargometadata.h"
+
+#include <interfaces/iproject.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QStandardPaths>
+
+#include "cargocache.h"
+#include "cargoplugin.h"
+#include "debug.h"
+
+using namespace KDevelop;
+
+QStringList CargoTarget::arguments() const
+{
+    switch (kind)
+    {
+        case Library:
+            return { QStringLiteral("--lib") };
+        case Binary:
+            return { QStringLiteral("--bin"), name };
+        case Example:
+            return { QStringLiteral("--example"), name };
+        case Test:
+            return { QStringLiteral("--test"), name };
+        case Bench:
+            return { QStringLiteral("--bench"), name };
+    }
+    return {};
+}
+
+CargoWorkspace CargoWorkspace::fromJson(const QJsonObject& metadata)
+{
+    static const QHash<QString, CargoTarget::Kind> kinds = {
+        { QStringLiteral("bin"), CargoTarget::Binary },
+        { QStringLiteral("example"), CargoTarget::Example },
+        { QStringLiteral("test"), CargoTarget::Test },
+        { QStringLiteral("bench"), CargoTarget::Bench },
+    };
+
+    CargoWorkspace workspace;
+    workspace.targetDirectory = Path(metadata.value(QStringLiteral("target_directory")).toString());
+
+    for (const auto& packageValue : metadata.value(QStringLiteral("packages")).toArray())
+    {
+        const QJsonObject packageObject = packageValue.toObject();
+
+        CargoPackage package;
+        package.name = packageObject.value(QStringLiteral("name")).toString();
+        package.manifest = Path(packageObject.value(QStringLiteral("manifest_path")).toString());
+
+        for (const auto& targetValue : packageObject.value(QStringLiteral("targets")).toArray())
+        {
+            const QJsonObject targetObject = targetValue.toObject();
+            const QString kind = targetObject.value(QStringLiteral("kind")).toArray().first().toString();
+
+            // Build scripts are not something users build or run themselves
+            if (kind == QStringLiteral("custom-build"))
+            {
+                continue;
+            }
+
+            CargoTarget target;
+            target.name = targetObject.value(QStringLiteral("name")).toString();
+            target.kind = kinds.value(kind, CargoTarget::Library);
+            target.sourcePath = Path(targetObject.value(QStringLiteral("src_path")).toString());
+            package.targets << target;
+        }
+
+        workspace.packages << package;
+    }
+
+    return workspace;
+}
+
+const CargoPackage* CargoWorkspace::packageInDirectory(const Path& directory) const
+{
+    for (const auto& package : packages)
+    {
+        if (package.manifest.parent() == directory)
+        {
+            return &package;
+        }
+    }
+    return nullptr;
+}
+
+CargoMetadata::CargoMetadata(QObject* parent)
+    : QObject(parent)
+{
+}
+
+CargoMetadata::~CargoMetadata()
+{
+    for (const auto& process : m_processes)
+    {
+        if (process)
+        {
+            process->kill();
+            process->waitForFinished();
+        }
+    }
+}
+
+QString CargoMetadata::cacheFileName(IProject* project)
+{
+    return CargoPlugin::dataDirectory(project) + QStringLiteral("/metadata.json");
+}
+
+void CargoMetadata::load(IProject* project)
+{
+    const QJsonObject cached = CargoCache(cacheFileName(project)).load();
+    if (!cached.isEmpty())
+    {
+        qCDebug(KDEV_CARGO) << "Using cached metadata of" << project->name();
+        m_workspaces[project] = CargoWorkspace::fromJson(cached);
+        emit workspaceChanged(project);
+        return;
+    }
+
+    runCargo(project);
+}
+
+void CargoMetadata::unload(IProject* project)
+{
+    m_workspaces.remove(project);
+    QPointer<QProcess> process = m_processes.take(project);
+    if (process)
+    {
+        process->disconnect(this);
+        process->kill();
+        process->deleteLater();
+    }
+}
+
+CargoWorkspace CargoMetadata::workspace(IProject* project) const
+{
+    return m_workspaces.value(project);
+}
+
+void CargoMetadata::runCargo(IProject* project)
+{
+    // The manifests changed again, so the metadata being read is already outdated
+    QPointer<QProcess>& process = m_processes[project];
+    if (process)
+    {
+        process->disconnect(this);
+        process->kill();
+        process->deleteLater();
+    }
+
+    process = new QProcess(this);
+    process->setProgram(QStandardPaths::findExecutable(QStringLiteral("cargo")));
+    process->setArguments({ QStringLiteral("metadata"), QStringLiteral("--format-version"), QStringLiteral("1"),
+                            QStringLiteral("--no-deps") });
+    process->setWorkingDirectory(project->path().toLocalFile());
+
+    QProcess* started = process;
+    connect(started, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [this, project, started]() {
+        cargoFinished(project, started);
+    });
+    connect(started, static_cast<void(QProcess::*)(QProcess::ProcessError)>(&QProcess::error), this, [this, project, started](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+        {
+            qCWarning(KDEV_CARGO) << "Could not run cargo metadata for" << project->name() << started->errorString();
+            m_processes.remove(project);
+            started->deleteLater();
+        }
+    });
+
+    qCDebug(KDEV_CARGO) << "Running cargo metadata for" << project->name();
+    started->start();
+}
+
+void CargoMetadata::cargoFinished(IProject* project, QProcess* process)
+{
+    m_processes.remove(project);
+    process->deleteLater();
+
+    if (process->exitStatus() != QProcess::NormalExit || process->exitCode() != 0)
+    {
+        qCWarning(KDEV_CARGO) << "cargo metadata failed for" << project->name() << process->readAllStandardError();
+        return;
+    }
+
+    const QJsonObject metadata = QJsonDocument::fromJson(process->readAllStandardOutput()).object();
+    const CargoWorkspace workspace = CargoWorkspace::fromJson(metadata);
+
+    // With --no-deps, the metadata only depends on the manifests of the workspace and its lock file
+    const QString root = project->path().toLocalFile();
+    QStringList dependencies = { root + QStringLiteral("/Cargo.toml"), root + QStringLiteral("/Cargo.lock") };
+    for (const auto& package : workspace.packages)
+    {
+        dependencies << package.manifest.toLocalFile();
+    }
+    dependencies.removeDuplicates();
+    CargoCache(cacheFileName(project)).store(metadata, dependencies);
+
+    m_workspaces[project] = workspace;
+    emit workspaceChanged(project);
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOMETADATA_H
+#define CARGOMETADATA_H
+
+#include <util/path.h>
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QVector>
+
+class QJsonObject;
+class QProcess;
+
+namespace KDevelop
+{
+class IProject;
+}
+
+struct CargoTarget
+{
+    enum Kind
+    {
+        Library,
+        Binary,
+        Example,
+        Test,
+        Bench
+    };
+
+    QString name;
+    Kind kind = Library;
+    KDevelop::Path sourcePath;
+
+    /// @return cargo arguments that select this target, such as "--bin name"
+    QStringList arguments() const;
+};
+
+struct CargoPackage
+{
+    QString name;
+    KDevelop::Path manifest;
+    QVector<CargoTarget> targets;
+};
+
+/**
+ * Packages of a workspace and their targets, as reported by `cargo metadata`.
+ */
+struct CargoWorkspace
+{
+    KDevelop::Path targetDirectory;
+    QVector<CargoPackage> packages;
+
+    /// Parses the output of `cargo metadata --format-version 1 --no-deps`
+    static CargoWorkspace fromJson(const QJsonObject& metadata);
+
+    /// @return the package whose manifest is in @p directory, or nullptr
+    const CargoPackage* packageInDirectory(const KDevelop::Path& directory) const;
+};
+
+/**
+ * Keeps the workspace metadata of all open cargo projects.
+ *
+ * Metadata is read from a cache in the target directory if none of the manifests changed,
+ * otherwise `cargo metadata` is run once, in the background, and the cache is updated.
+ */
+class CargoMetadata : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CargoMetadata(QObject* parent = nullptr);
+    ~CargoMetadata() override;
+
+    /// Starts loading the metadata of @p project, and emits workspaceChanged() when it is known
+    void load(KDevelop::IProject* project);
+    void unload(KDevelop::IProject* project);
+
+    /// @return the last known metadata of @p project, which is empty while it is loading for the first time
+    CargoWorkspace workspace(KDevelop::IProject* project) const;
+
+signals:
+    void workspaceChanged(KDevelop::IProject* project);
+
+private:
+    static QString cacheFileName(KDevelop::IProject* project);
+    void runCargo(KDevelop::IProject* project);
+    void cargoFinished(KDevelop::IProject* project, QProcess* process);
+
+    QHash<KDevelop::IProject*, CargoWorkspace> m_workspaces;
+    QHash<KDevelop::IProject*, QPointer<QProcess>> m_processes;
+};
+
+#endif
@@ -0,0 +1,268 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargooutputmodel.h"
+
+#include <KLocalizedString>
+#include <KTextEditor/Cursor>
+
+#include <interfaces/icore.h>
+#include <interfaces/idocumentcontroller.h>
+#include <outputview/outputmodel.h>
+
+#include <QFontDatabase>
+
+using namespace KDevelop;
+
+namespace
+{
+
+bool isImportant(const FilteredItem& item)
+{
+    return item.type == FilteredItem::ErrorItem || item.type == FilteredItem::WarningItem;
+}
+
+}
+
+CargoOutputModel::CargoOutputModel(const QUrl& buildDir, int recentLines, const QString& logFile, QObject* parent)
+    : QAbstractListModel(parent)
+    , m_buildDir(buildDir)
+    , m_recentLines(qMax(1, recentLines))
+    , m_logItem(QString(), FilteredItem::InformationItem)
+    , m_hasLogItem(false)
+    , m_droppedLines(0)
+{
+    m_logItem.isActivatable = true;
+    m_logItem.url = QUrl::fromLocalFile(logFile);
+    m_logItem.lineNo = 0;
+    m_logItem.columnNo = 0;
+}
+
+CargoOutputModel::~CargoOutputModel()
+{
+}
+
+int CargoOutputModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+    return recentOffset() + m_recent.size();
+}
+
+QVariant CargoOutputModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount())
+    {
+        return QVariant();
+    }
+
+    const FilteredItem& item = itemAt(index.row());
+    switch (role)
+    {
+        case Qt::DisplayRole:
+            return item.originalLine;
+        case OutputModel::OutputItemTypeRole:
+            return static_cast<int>(item.type);
+        case Qt::FontRole:
+            return QFontDatabase::systemFont(QFontDatabase::FixedFont);
+        default:
+            return QVariant();
+    }
+}
+
+void CargoOutputModel::appendLine(const QString& line)
+{
+    appendItems({ FilteredItem(line, FilteredItem::StandardItem) });
+}
+
+void CargoOutputModel::appendItems(const QVector<FilteredItem>& items)
+{
+    if (items.isEmpty())
+    {
+        return;
+    }
+
+    const int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + items.size() - 1);
+    for (const auto& item : items)
+    {
+        m_recent.append(item);
+    }
+    endInsertRows();
+
+    dropOldLines();
+}
+
+const FilteredItem& CargoOutputModel::itemAt(int row) const
+{
+    if (m_hasLogItem)
+    {
+        if (row == 0)
+        {
+            return m_logItem;
+        }
+        --row;
+    }
+
+    if (row < m_retained.size())
+    {
+        return m_retained.at(row);
+    }
+    return m_recent.at(row - m_retained.size());
+}
+
+int CargoOutputModel::recentOffset() const
+{
+    return (m_hasLogItem ? 1 : 0) + m_retained.size();
+}
+
+void CargoOutputModel::insertLogItem()
+{
+    if (!m_hasLogItem)
+    {
+        beginInsertRows(QModelIndex(), 0, 0);
+        m_hasLogItem = true;
+        endInsertRows();
+    }
+}
+
+void CargoOutputModel::dropOldLines()
+{
+    int excess = m_recent.size() - m_recentLines;
+    const qint64 droppedBefore = m_droppedLines;
+
+    while (excess > 0)
+    {
+        if (isImportant(m_recent.first()))
+        {
+            // Moving an item from the recent lines to the retained ones does not change its row
+            m_retained.append(m_recent.takeFirst());
+            --excess;
+            continue;
+        }
+
+        insertLogItem();
+
+        // Remove a whole run of ordinary lines at once
+        int count = 1;
+        while (count < excess && !isImportant(m_recent.at(count)))
+        {
+            ++count;
+        }
+
+        const int row = recentOffset();
+        beginRemoveRows(QModelIndex(), row, row + count - 1);
+        m_recent.erase(m_recent.begin(), m_recent.begin() + count);
+        endRemoveRows();
+
+        m_droppedLines += count;
+        excess -= count;
+    }
+
+    excess = m_retained.size() - MaxRetainedItems;
+    if (excess > 0)
+    {
+        // Even errors and warnings are dropped eventually, the oldest first
+        insertLogItem();
+        beginRemoveRows(QModelIndex(), 1, excess);
+        m_retained.erase(m_retained.begin(), m_retained.begin() + excess);
+        endRemoveRows();
+
+        m_droppedLines += excess;
+    }
+
+    if (m_droppedLines != droppedBefore)
+    {
+        m_logItem.originalLine = i18np("%1 earlier line is only kept in the full log, activate this line to open it",
+                                       "%1 earlier lines are only kept in the full log, activate this line to open it",
+                                       m_droppedLines);
+        const QModelIndex logIndex = index(0);
+        emit dataChanged(logIndex, logIndex);
+    }
+}
+
+void CargoOutputModel::activate(const QModelIndex& index)
+{
+    if (index.model() != this || !index.isValid() || index.row() >= rowCount())
+    {
+        return;
+    }
+
+    const FilteredItem& item = itemAt(index.row());
+    if (!item.isActivatable || item.url.isEmpty())
+    {
+        return;
+    }
+
+    QUrl url = item.url;
+    if (url.isRelative())
+    {
+        url = m_buildDir.resolved(url);
+    }
+    ICore::self()->documentController()->openDocument(url, KTextEditor::Cursor(item.lineNo, item.columnNo));
+}
+
+QModelIndex CargoOutputModel::findHighlight(int startRow, int step) const
+{
+    const int rows = rowCount();
+    if (rows == 0)
+    {
+        return QModelIndex();
+    }
+
+    // Like KDevelop::OutputModel, prefer errors and warnings over other activatable lines
+    for (bool importantOnly : {true, false})
+    {
+        for (int i = 0; i < rows; ++i)
+        {
+            const int row = ((startRow + i * step) % rows + rows) % rows;
+            const FilteredItem& item = itemAt(row);
+            if (item.isActivatable && (!importantOnly || isImportant(item)))
+            {
+                return index(row);
+            }
+        }
+    }
+    return QModelIndex();
+}
+
+QModelIndex CargoOutputModel::firstHighlightIndex()
+{
+    return findHighlight(0, 1);
+}
+
+QModelIndex CargoOutputModel::lastHighlightIndex()
+{
+    return findHighlight(rowCount() - 1, -1);
+}
+
+QModelIndex CargoOutputModel::nextHighlightIndex(const QModelIndex& currentIndex)
+{
+    return findHighlight(currentIndex.isValid() ? currentIndex.row() + 1 : 0, 1);
+}
+
+QModelIndex CargoOutputModel::previousHighlightIndex(const QModelIndex& currentIndex)
+{
+    return findHighlight(currentIndex.isValid() ? currentIndex.row() - 1 : rowCount() - 1, -1);
+}
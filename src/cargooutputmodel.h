@@ -0,0 +1,87 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOOUTPUTMODEL_H
+#define CARGOOUTPUTMODEL_H
+
+#include <outputview/filtereditem.h>
+#include <outputview/ioutputviewmodel.h>
+
+#include <QAbstractListModel>
+#include <QUrl>
+#include <QVector>
+
+/**
+ * Output model with bounded memory use, for very long build and run output.
+ *
+ * Only the most recent lines are kept, together with up to MaxRetainedItems older errors and warnings.
+ * The complete output is written to a log file by the CargoOutputPipeline,
+ * and a row at the top of the model opens that file when activated.
+ * Output lines arrive already classified, so the model does not parse them.
+ */
+class CargoOutputModel : public QAbstractListModel, public KDevelop::IOutputViewModel
+{
+    Q_OBJECT
+public:
+    /**
+     * @param recentLines the number of most recent lines to keep, not counting errors and warnings
+     * @param logFile the file containing the complete output
+     */
+    CargoOutputModel(const QUrl& buildDir, int recentLines, const QString& logFile, QObject* parent = nullptr);
+    ~CargoOutputModel() override;
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    void activate(const QModelIndex& index) override;
+    QModelIndex firstHighlightIndex() override;
+    QModelIndex nextHighlightIndex(const QModelIndex& currentIndex) override;
+    QModelIndex previousHighlightIndex(const QModelIndex& currentIndex) override;
+    QModelIndex lastHighlightIndex() override;
+
+    enum { MaxRetainedItems = 1000 };
+
+public slots:
+    /// Append a line that is not process output, such as the command line, as a standard item
+    void appendLine(const QString& line);
+    void appendItems(const QVector<KDevelop::FilteredItem>& items);
+
+private:
+    const KDevelop::FilteredItem& itemAt(int row) const;
+    int recentOffset() const;
+    void insertLogItem();
+    void dropOldLines();
+    QModelIndex findHighlight(int startRow, int step) const;
+
+    QUrl m_buildDir;
+    int m_recentLines;
+
+    KDevelop::FilteredItem m_logItem;
+    bool m_hasLogItem;
+    qint64 m_droppedLines;
+
+    /// Errors and warnings that are older than the most recent lines
+    QVector<KDevelop::FilteredItem> m_retained;
+    QList<KDevelop::FilteredItem> m_recent;
+};
+
+#endif
@@ -0,0 +1,260 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargooutputpipeline.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTimer>
+
+#include "debug.h"
+
+using namespace KDevelop;
+
+CargoOutputPipeline::CargoOutputPipeline(const QString& program, const QStringList& arguments, const QString& workingDirectory,
+                                         bool jsonDiagnostics,
+                                         const QSharedPointer<CargoClassifiedItems>& classifiedItems)
+ : QObject()
+ , m_program(program)
+ , m_arguments(arguments)
+ , m_workingDirectory(workingDirectory)
+ , m_jsonDiagnostics(jsonDiagnostics)
+ , m_classifiedItems(classifiedItems)
+ , m_process(nullptr)
+ , m_batchTimer(nullptr)
+ , m_logFile(nullptr)
+ , m_messageParser(Path(workingDirectory))
+ , m_filterStrategy(QUrl::fromLocalFile(workingDirectory))
+{
+    qRegisterMetaType<QVector<CargoDiagnostic>>();
+    qRegisterMetaType<QVector<CargoArtifact>>();
+    qRegisterMetaType<QVector<FilteredItem>>();
+}
+
+CargoOutputPipeline::~CargoOutputPipeline()
+{
+}
+
+void CargoOutputPipeline::setLogFile(const QString& fileName, const QString& header)
+{
+    m_logFileName = fileName;
+    m_logHeader = header;
+}
+
+void CargoOutputPipeline::start()
+{
+    // Children are created here, so that they live in the pipeline's thread
+    m_batchTimer = new QTimer(this);
+    m_batchTimer->setInterval(BatchInterval);
+    connect(m_batchTimer, &QTimer::timeout, this, &CargoOutputPipeline::flush);
+
+    if (!m_logFileName.isEmpty())
+    {
+        QDir().mkpath(QFileInfo(m_logFileName).absolutePath());
+        m_logFile = new QFile(m_logFileName, this);
+        if (!m_logFile->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            qCWarning(KDEV_CARGO) << "Could not open output log" << m_logFileName << m_logFile->errorString();
+            delete m_logFile;
+            m_logFile = nullptr;
+        }
+        else if (!m_logHeader.isEmpty())
+        {
+            m_logFile->write(m_logHeader.toUtf8());
+            m_logFile->write("\n", 1);
+        }
+    }
+
+    m_process = new QProcess(this);
+    m_process->setProgram(m_program);
+    m_process->setArguments(m_arguments);
+    m_process->setWorkingDirectory(m_workingDirectory);
+
+    connect(m_process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, &CargoOutputPipeline::procFinished);
+    connect(m_process, static_cast<void(QProcess::*)(QProcess::ProcessError)>(&QProcess::error),
+            this, &CargoOutputPipeline::procError);
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &CargoOutputPipeline::readStandardOutput);
+    connect(m_process, &QProcess::readyReadStandardError, this, &CargoOutputPipeline::readStandardError);
+
+    m_batchTimer->start();
+    m_process->start();
+}
+
+void CargoOutputPipeline::kill()
+{
+    if (m_process)
+    {
+        m_process->kill();
+    }
+}
+
+void CargoOutputPipeline::readStandardOutput()
+{
+    const QByteArray output = m_process->readAllStandardOutput();
+    if (m_jsonDiagnostics)
+    {
+        addItems(m_messageParser.feed(output));
+    }
+    else
+    {
+        addPlainLines(&m_stdoutBuffer, output);
+    }
+}
+
+void CargoOutputPipeline::readStandardError()
+{
+    addPlainLines(&m_stderrBuffer, m_process->readAllStandardError());
+}
+
+void CargoOutputPipeline::addPlainLines(QByteArray* buffer, const QByteArray& chunk)
+{
+    buffer->append(chunk);
+
+    int start = 0;
+    int end;
+    while ((end = buffer->indexOf('\n', start)) != -1)
+    {
+        addPlainLine(buffer->mid(start, end - start));
+        start = end + 1;
+    }
+    buffer->remove(0, start);
+}
+
+void CargoOutputPipeline::addPlainLine(const QByteArray& line)
+{
+    QString text = QString::fromLocal8Bit(line);
+    if (text.endsWith(QLatin1Char('\r')))
+    {
+        text.chop(1);
+    }
+
+    m_pendingLines << text;
+    m_pendingItems << m_filterStrategy.errorInLine(text);
+}
+
+void CargoOutputPipeline::addItems(const QVector<FilteredItem>& items)
+{
+    for (const auto& item : items)
+    {
+        // Unclassified items are plain text between JSON messages, such as build script output
+        m_pendingLines << item.originalLine;
+        m_pendingItems << (item.type == FilteredItem::InvalidItem ? m_filterStrategy.errorInLine(item.originalLine) : item);
+    }
+}
+
+void CargoOutputPipeline::drainProcess()
+{
+    readStandardOutput();
+    readStandardError();
+
+    if (m_jsonDiagnostics)
+    {
+        addItems(m_messageParser.flush());
+    }
+    if (!m_stdoutBuffer.isEmpty())
+    {
+        addPlainLine(m_stdoutBuffer);
+        m_stdoutBuffer.clear();
+    }
+    if (!m_stderrBuffer.isEmpty())
+    {
+        addPlainLine(m_stderrBuffer);
+        m_stderrBuffer.clear();
+    }
+
+    m_batchTimer->stop();
+    flush();
+
+    if (m_logFile)
+    {
+        m_logFile->close();
+    }
+}
+
+void CargoOutputPipeline::flush()
+{
+    if (!m_pendingLines.isEmpty())
+    {
+        if (m_logFile)
+        {
+            for (const auto& line : m_pendingLines)
+            {
+                m_logFile->write(line.toUtf8());
+                m_logFile->write("\n", 1);
+            }
+        }
+
+        // The items have to be queued before the model can see their lines
+        if (m_classifiedItems)
+        {
+            m_classifiedItems->enqueue(m_pendingItems);
+        }
+        emit linesReady(m_pendingLines);
+        emit itemsReady(m_pendingItems);
+
+        m_pendingLines.clear();
+        m_pendingItems.clear();
+    }
+
+    if (m_jsonDiagnostics)
+    {
+        const QVector<CargoDiagnostic> diagnostics = m_messageParser.takeDiagnostics();
+        if (!diagnostics.isEmpty())
+        {
+            emit diagnosticsReady(diagnostics);
+        }
+
+        const QVector<CargoArtifact> artifacts = m_messageParser.takeArtifacts();
+        if (!artifacts.isEmpty())
+        {
+            emit artifactsReady(artifacts);
+        }
+    }
+}
+
+void CargoOutputPipeline::procFinished(int code, QProcess::ExitStatus status)
+{
+    drainProcess();
+
+    // A crashed or killed process is finished as well, so this is the only place that reports it
+    if (status != QProcess::NormalExit)
+    {
+        emit processFailed(QProcess::Crashed);
+        return;
+    }
+    emit processFinished(code);
+}
+
+void CargoOutputPipeline::procError(QProcess::ProcessError error)
+{
+    // Only a process that did not start is not followed by procFinished(), other errors do not end the process
+    if (error != QProcess::FailedToStart)
+    {
+        qCDebug(KDEV_CARGO) << "Error while running" << m_program << error;
+        return;
+    }
+
+    drainProcess();
+    emit processFailed(error);
+}
@@ -0,0 +1,121 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOOUTPUTPIPELINE_H
+#define CARGOOUTPUTPIPELINE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include "cargofilterstrategy.h"
+#include "cargomessageparser.h"
+
+class QFile;
+class QTimer;
+
+/**
+ * Runs a cargo process and turns its output into classified output lines.
+ *
+ * The pipeline is meant to live in a worker thread, so that reading the process pipes,
+ * splitting lines, parsing JSON messages and classifying lines does not compete with the editor.
+ * Classified items are handed over in batches at most every BatchInterval milliseconds,
+ * either directly to a CargoOutputModel, or as lines to a KDevelop::OutputModel
+ * whose CargoFilterStrategy takes the items from the shared CargoClassifiedItems queue.
+ */
+class CargoOutputPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    enum { BatchInterval = 50 };
+
+    CargoOutputPipeline(const QString& program, const QStringList& arguments, const QString& workingDirectory,
+                        bool jsonDiagnostics,
+                        const QSharedPointer<CargoClassifiedItems>& classifiedItems = QSharedPointer<CargoClassifiedItems>());
+    ~CargoOutputPipeline() override;
+
+    /**
+     * Also write every line of output to @p fileName, which is replaced if it exists.
+     *
+     * The log starts with @p header, usually the command line, and ends with the last line of output.
+     * Status lines that the job adds after the process finished are not part of it.
+     */
+    void setLogFile(const QString& fileName, const QString& header = QString());
+
+public slots:
+    void start();
+    void kill();
+
+signals:
+    /// A batch of output lines, whose classified items have already been queued, if there is a queue
+    void linesReady(const QStringList& lines);
+
+    /// The same batch as linesReady(), with each line already classified
+    void itemsReady(const QVector<KDevelop::FilteredItem>& items);
+
+    /// Diagnostics parsed from JSON messages, emitted right after the lines they were rendered to
+    void diagnosticsReady(const QVector<CargoDiagnostic>& diagnostics);
+
+    /// Artifacts parsed from JSON messages, fresh ones included, which are not shown as lines
+    void artifactsReady(const QVector<CargoArtifact>& artifacts);
+
+    /// The process exited normally with @p exitCode
+    void processFinished(int exitCode);
+
+    /// The process failed to start or crashed, @p error is a QProcess::ProcessError
+    void processFailed(int error);
+
+private:
+    void readStandardOutput();
+    void readStandardError();
+    void procFinished(int code, QProcess::ExitStatus status);
+    void procError(QProcess::ProcessError error);
+
+    void addPlainLines(QByteArray* buffer, const QByteArray& chunk);
+    void addPlainLine(const QByteArray& line);
+    void addItems(const QVector<KDevelop::FilteredItem>& items);
+    void drainProcess();
+    void flush();
+
+    QString m_program;
+    QStringList m_arguments;
+    QString m_workingDirectory;
+    bool m_jsonDiagnostics;
+    QSharedPointer<CargoClassifiedItems> m_classifiedItems;
+
+    QString m_logFileName;
+    QString m_logHeader;
+
+    QProcess* m_process;
+    QTimer* m_batchTimer;
+    QFile* m_logFile;
+    CargoMessageParser m_messageParser;
+    CargoFilterStrategy m_filterStrategy;
+    QByteArray m_stdoutBuffer;
+    QByteArray m_stderrBuffer;
+
+    QStringList m_pendingLines;
+    QVector<KDevelop::FilteredItem> m_pendingItems;
+};
+
+#endif
@@ -27,6 +27,8 @@
 #include <KConfigGroup>
 #include <KShell>
 #include <QAction>
+#include <QApplication>
+#include <QFileInfo>
 #include <QDebug>
 
 #include <project/projectmodel.h>
@@ -37,10 +39,28 @@
 #include <interfaces/contextmenuextension.h>
 #include <interfaces/context.h>
 #include <interfaces/iprojectcontroller.h>
+#include <interfaces/idocument.h>
+#include <interfaces/idocumentcontroller.h>
+#include <interfaces/itestcontroller.h>
+#include <interfaces/itestsuite.h>
 
+#include "cargobenchmarkresults.h"
+#include "cargobenchmarkresultsdialog.h"
 #include "cargobuildjob.h"
+#include "cargocheckscheduler.h"
+#include "cargofindbenchmarksjob.h"
 #include "cargofindtestsjob.h"
 #include "cargoexecutionconfig.h"
+#include "cargomanifest.h"
+#include "cargometadata.h"
+#include "cargotargetitem.h"
+#include "cargodepinfoindex.h"
+#include "cargoproblemreporter.h"
+#include "cargotesthistory.h"
+#include "cargotestscheduler.h"
+#include "cargotesttimesdialog.h"
+#include "cargorepeattestsdialog.h"
+#include "cargoprojectconfigpage.h"
 #include "debug.h"
 
 using KDevelop::ProjectTargetItem;
@@ -65,6 +85,14 @@ CargoPlugin::CargoPlugin( QObject *parent, const QVariantList & )
     m_configType->addLauncher( new CargoLauncher( this ) );
     core()->runController()->addConfigurationType( m_configType );
 
+    m_problemReporter = new CargoProblemReporter( this );
+    new CargoCheckScheduler( this );
+    m_testScheduler = new CargoTestScheduler( this );
+
+    m_buildPackageAction = new QAction(this);
+    m_buildPackageAction->setIcon(QIcon::fromTheme(QStringLiteral("run-build")));
+    m_buildPackageAction->setText(i18n("Build Cargo Package"));
+
     m_buildTestsAction = new QAction(this);
     m_buildTestsAction->setIcon(QIcon::fromTheme(QStringLiteral("preflight-verifier")));
     m_buildTestsAction->setText(i18n("Build Cargo Tests"));
@@ -73,17 +101,94 @@ CargoPlugin::CargoPlugin( QObject *parent, const QVariantList & )
     m_runTestsAction->setIcon(QIcon::fromTheme(QStringLiteral("system-run")));
     m_runTestsAction->setText(i18n("Run Cargo Tests"));
 
+    m_runTestSuitesAction = new QAction(this);
+    m_runTestSuitesAction->setIcon(QIcon::fromTheme(QStringLiteral("system-run")));
+    m_runTestSuitesAction->setText(i18n("Run Cargo Test Suites in Parallel"));
+
+    m_runAffectedTestsAction = new QAction(this);
+    m_runAffectedTestsAction->setIcon(QIcon::fromTheme(QStringLiteral("system-run")));
+    m_runAffectedTestsAction->setText(i18n("Run Affected Cargo Tests"));
+
+    m_rerunFailedTestsAction = new QAction(this);
+    m_rerunFailedTestsAction->setIcon(QIcon::fromTheme(QStringLiteral("view-refresh")));
+    m_rerunFailedTestsAction->setText(i18n("Rerun Failed Cargo Tests"));
+
+    m_repeatTestsAction = new QAction(this);
+    m_repeatTestsAction->setIcon(QIcon::fromTheme(QStringLiteral("media-playlist-repeat")));
+    m_repeatTestsAction->setText(i18n("Repeat Cargo Tests..."));
+
+    m_testTimesAction = new QAction(this);
+    m_testTimesAction->setIcon(QIcon::fromTheme(QStringLiteral("chronometer")));
+    m_testTimesAction->setText(i18n("Show Cargo Test Times"));
+
+    m_buildBenchmarksAction = new QAction(this);
+    m_buildBenchmarksAction->setIcon(QIcon::fromTheme(QStringLiteral("run-build")));
+    m_buildBenchmarksAction->setText(i18n("Build Cargo Benchmarks"));
+
+    m_runBenchmarksAction = new QAction(this);
+    m_runBenchmarksAction->setIcon(QIcon::fromTheme(QStringLiteral("system-run")));
+    m_runBenchmarksAction->setText(i18n("Run Cargo Benchmarks"));
+
+    m_benchmarkResultsAction = new QAction(this);
+    m_benchmarkResultsAction->setIcon(QIcon::fromTheme(QStringLiteral("office-chart-bar")));
+    m_benchmarkResultsAction->setText(i18n("Show Cargo Benchmark Results"));
+
     connect(core()->projectController(), &KDevelop::IProjectController::projectOpened, [this](IProject* project) {
         if (project->buildSystemManager() == this)
         {
+            m_depInfoIndexes.insert(project, new CargoDepInfoIndex(project->path().toLocalFile()));
+
             CargoFindTestsJob* findTestsJob = new CargoFindTestsJob(this, project->projectItem());
             core()->runController()->registerJob(findTestsJob);
+
+            // Benchmark harnesses built in an earlier session
+            core()->runController()->registerJob(new CargoFindBenchmarksJob(this, project));
+        }
+    });
+
+    m_metadata = new CargoMetadata( this );
+    connect(m_metadata, &CargoMetadata::workspaceChanged, this, [this](IProject* project) {
+        const CargoWorkspace workspace = m_metadata->workspace(project);
+        if (workspace.targetDirectory.isValid())
+        {
+            m_targetDirectories[project] = workspace.targetDirectory;
+
+            KConfigGroup config( project->projectConfiguration(), "Cargo" );
+            if (config.readEntry( "Target Directory", QString() ) != workspace.targetDirectory.toLocalFile())
+            {
+                config.writeEntry( "Target Directory", workspace.targetDirectory.toLocalFile() );
+            }
+        }
+
+        // The metadata may be known before the project has its root item
+        if (project->projectItem())
+        {
+            updateTargets(project->projectItem(), workspace);
+        }
+    });
+    connect(core()->projectController(), &KDevelop::IProjectController::projectClosing, this, [this](IProject* project) {
+        m_metadata->unload(project);
+        m_targetDirectories.remove(project);
+        delete m_depInfoIndexes.take(project);
+    });
+
+    // Editing a manifest can add or remove targets, or whole packages
+    connect(core()->documentController(), &KDevelop::IDocumentController::documentSaved, this, [this](KDevelop::IDocument* document) {
+        if (document->url().fileName() != QLatin1String("Cargo.toml"))
+        {
+            return;
+        }
+        IProject* project = core()->projectController()->findProjectForUrl(document->url());
+        if (project && project->buildSystemManager() == this)
+        {
+            m_metadata->load(project);
         }
     });
 }
 
 CargoPlugin::~CargoPlugin()
 {
+    qDeleteAll(m_depInfoIndexes);
 }
 
 void CargoPlugin::unload()
@@ -91,6 +196,12 @@ void CargoPlugin::unload()
     core()->runController()->removeConfigurationType( m_configType );
     delete m_configType;
     m_configType = nullptr;
+
+    delete m_problemReporter;
+    m_problemReporter = nullptr;
+
+    delete m_testScheduler;
+    m_testScheduler = nullptr;
 }
 
 bool CargoPlugin::addFilesToTarget( const QList<ProjectFileItem*>&, ProjectTargetItem* )
@@ -105,7 +216,75 @@ bool CargoPlugin::hasBuildInfo( ProjectBaseItem* ) const
 
 KJob* CargoPlugin::build( ProjectBaseItem* dom )
 {
-    return new CargoBuildJob( this, dom, QStringLiteral("build") );
+    auto job = new CargoBuildJob( this, dom, QStringLiteral("build") );
+    job->setJsonDiagnostics(true);
+
+    Path packageDir;
+    job->setRunArguments( packageArguments( dom, true, &packageDir ) );
+    if (packageDir.isValid())
+    {
+        job->setDiagnosticsScope( packageDir );
+    }
+    return job;
+}
+
+QStringList CargoPlugin::packageArguments( ProjectBaseItem* item, bool withTarget, Path* packageDir ) const
+{
+    if (item->isProjectRoot())
+    {
+        return {};
+    }
+
+    // Targets from cargo metadata are exact, even when they do not follow the conventional layout
+    for (ProjectBaseItem* parent = item; parent; parent = parent->parent())
+    {
+        if (auto target = dynamic_cast<CargoTargetItem*>( parent ))
+        {
+            // Target items are created in the folder of their package
+            if (packageDir && parent->parent())
+            {
+                *packageDir = parent->parent()->path();
+            }
+
+            QStringList arguments = { QStringLiteral("-p"), target->packageName() };
+            if (withTarget)
+            {
+                arguments << target->cargoTarget().arguments();
+            }
+            return arguments;
+        }
+    }
+
+    const Path root = item->project()->path();
+    const Path manifest = CargoManifest::findPackageManifest( item->path(), root );
+    if (!manifest.isValid())
+    {
+        return {};
+    }
+
+    const QString package = CargoManifest::packageName( manifest );
+    if (packageDir)
+    {
+        *packageDir = manifest.parent();
+    }
+
+    QStringList arguments = { QStringLiteral("-p"), package };
+    if (withTarget)
+    {
+        arguments << CargoManifest::targetArguments( item->path(), manifest.parent(), package );
+    }
+    return arguments;
+}
+
+bool CargoPlugin::isPackageFolder( ProjectBaseItem* item ) const
+{
+    if (!item->folder())
+    {
+        return false;
+    }
+
+    const Path manifest( item->path(), QStringLiteral("Cargo.toml") );
+    return !CargoManifest::packageName( manifest ).isEmpty();
 }
 
 Path CargoPlugin::buildDirectory( ProjectBaseItem*  item ) const
@@ -120,7 +299,10 @@ IProjectBuilder* CargoPlugin::builder() const
 
 KJob* CargoPlugin::clean( ProjectBaseItem* dom )
 {
-    return new CargoBuildJob( this, dom, QStringLiteral("clean") );
+    // Cargo can only clean whole packages
+    auto job = new CargoBuildJob( this, dom, QStringLiteral("clean") );
+    job->setRunArguments( packageArguments( dom, false ) );
+    return job;
 }
 
 KJob* CargoPlugin::configure( IProject* project )
@@ -143,10 +325,107 @@ IProjectFileManager::Features CargoPlugin::features() const
     return IProjectFileManager::Files | IProjectFileManager::Folders;
 }
 
+ProjectFolderItem* CargoPlugin::import( IProject* project )
+{
+    // Cached metadata is available right away, and tells which target directory to skip
+    m_metadata->load( project );
+    return AbstractFileManagerPlugin::import( project );
+}
+
+bool CargoPlugin::isValid( const Path& path, const bool isFolder, IProject* project ) const
+{
+    if (isFolder)
+    {
+        /*
+         * Build output has orders of magnitude more files than the sources,
+         * and would only slow down loading and use up inotify watches.
+         */
+        if (path == targetDirectory( project ))
+        {
+            return false;
+        }
+
+        const QString name = path.lastPathSegment();
+        if (name == QLatin1String("target"))
+        {
+            // Packages outside of the workspace have their own target directories
+            if (QFileInfo::exists( path.parent().toLocalFile() + QStringLiteral("/Cargo.toml") ))
+            {
+                return false;
+            }
+        }
+        else if ((name == QLatin1String("registry") || name == QLatin1String("git"))
+                 && path.parent().lastPathSegment() == QLatin1String(".cargo"))
+        {
+            // Crates downloaded into a project-local CARGO_HOME
+            return false;
+        }
+    }
+
+    return AbstractFileManagerPlugin::isValid( path, isFolder, project );
+}
+
+Path CargoPlugin::targetDirectory( IProject* project ) const
+{
+    const auto it = m_targetDirectories.constFind( project );
+    if (it != m_targetDirectories.constEnd())
+    {
+        return *it;
+    }
+
+    // Until the metadata is known, the target directory of the last session is assumed, so that its caches are found
+    KConfigGroup config( project->projectConfiguration(), "Cargo" );
+    const QString lastDirectory = config.readEntry( "Target Directory", QString() );
+    return lastDirectory.isEmpty() ? Path( project->path(), QStringLiteral("target") ) : Path( lastDirectory );
+}
+
+QString CargoPlugin::dataDirectory( IProject* project )
+{
+    // Suites and their jobs only know their project, whose build system manager is this plugin
+    auto plugin = dynamic_cast<CargoPlugin*>( project->buildSystemManager() );
+    const Path target = plugin ? plugin->targetDirectory( project ) : Path( project->path(), QStringLiteral("target") );
+    return target.toLocalFile() + QStringLiteral("/kdevelop");
+}
+
 ProjectFolderItem* CargoPlugin::createFolderItem( IProject* project,
                     const Path& path, ProjectBaseItem* parent )
 {
-    return new ProjectBuildFolderItem( project, path, parent );
+    auto folder = new ProjectBuildFolderItem( project, path, parent );
+
+    // Folders are created while the project is loaded, which may be after its metadata is known
+    const CargoWorkspace workspace = m_metadata->workspace( project );
+    if (const CargoPackage* package = workspace.packageInDirectory( path ))
+    {
+        for (const auto& target : package->targets)
+        {
+            CargoTargetItem::create( project, workspace, *package, target, folder );
+        }
+    }
+    return folder;
+}
+
+void CargoPlugin::updateTargets( ProjectFolderItem* folder, const CargoWorkspace& workspace )
+{
+    for (auto target : folder->targetList())
+    {
+        if (dynamic_cast<CargoTargetItem*>( target ))
+        {
+            delete target;
+        }
+    }
+
+    if (const CargoPackage* package = workspace.packageInDirectory( folder->path() ))
+    {
+        for (const auto& target : package->targets)
+        {
+            CargoTargetItem::create( folder->project(), workspace, *package, target, folder );
+        }
+    }
+
+    for (auto subFolder : folder->folderList())
+    {
+        updateTargets( subFolder, workspace );
+    }
 }
 
 Path::List CargoPlugin::includeDirectories( ProjectBaseItem* ) const
@@ -163,6 +442,14 @@ KJob* CargoPlugin::install( KDevelop::ProjectBaseItem* item, const QUrl &install
 {
     auto job = new CargoBuildJob( this, item, QStringLiteral("install") );
     job->setInstallPrefix(installPrefix);
+
+    // Install only takes a single package, which it reads from the given path
+    Path packageDir;
+    packageArguments( item, false, &packageDir );
+    if (packageDir.isValid())
+    {
+        job->setRunArguments({ QStringLiteral("--path"), packageDir.toLocalFile() });
+    }
     return job;
 }
 
@@ -181,9 +468,9 @@ bool CargoPlugin::removeTarget( ProjectTargetItem* )
     return false;
 }
 
-QList<ProjectTargetItem*> CargoPlugin::targets( ProjectFolderItem* ) const
+QList<ProjectTargetItem*> CargoPlugin::targets( ProjectFolderItem* folder ) const
 {
-    return QList<ProjectTargetItem*>();
+    return folder->targetList();
 }
 
 KDevelop::Path CargoPlugin::compiler(KDevelop::ProjectTargetItem* p) const
@@ -195,14 +482,15 @@ KDevelop::Path CargoPlugin::compiler(KDevelop::ProjectTargetItem* p) const
 
 int CargoPlugin::perProjectConfigPages() const
 {
-    return 0;
+    return 1;
 }
 
 KDevelop::ConfigPage* CargoPlugin::perProjectConfigPage(int number, const KDevelop::ProjectConfigOptions& options, QWidget* parent)
 {
-    Q_UNUSED(number);
-    Q_UNUSED(options);
-    Q_UNUSED(parent);
+    if (number == 0)
+    {
+        return new CargoProjectConfigPage(this, options, parent);
+    }
     return nullptr;
 }
 
@@ -281,18 +569,81 @@ KDevelop::ContextMenuExtension CargoPlugin::contextMenuExtension(KDevelop::Conte
         if (projectContext->items().size() == 1)
         {
             auto item = projectContext->items().first();
-            if (item->isProjectRoot() && item->project()->buildSystemManager() == this)
+            if (item->project()->buildSystemManager() == this && (item->isProjectRoot() || isPackageFolder(item)))
             {
+                if (!item->isProjectRoot())
+                {
+                    m_buildPackageAction->disconnect();
+                    connect(m_buildPackageAction, &QAction::triggered, this, [this, item](){
+                        core()->runController()->registerJob(build(item));
+                    });
+                    menuExt.addAction(KDevelop::ContextMenuExtension::BuildGroup, m_buildPackageAction);
+                }
+
                 m_buildTestsAction->disconnect();
                 connect(m_buildTestsAction, &QAction::triggered, this, [this, item](){
-                    runBuildTestsJob(item, false);
+                    runBuildTestsJob(item, BuildTests);
                 });
                 m_runTestsAction->disconnect();
                 connect(m_runTestsAction, &QAction::triggered, this, [this, item](){
-                    runBuildTestsJob(item, true);
+                    runBuildTestsJob(item, RunTests);
+                });
+                m_runTestSuitesAction->disconnect();
+                connect(m_runTestSuitesAction, &QAction::triggered, this, [this, item](){
+                    runBuildTestsJob(item, RunTestSuites);
+                });
+                m_runAffectedTestsAction->disconnect();
+                connect(m_runAffectedTestsAction, &QAction::triggered, this, [this, item](){
+                    runBuildTestsJob(item, RunAffectedTests);
                 });
                 menuExt.addAction(KDevelop::ContextMenuExtension::RunGroup, m_buildTestsAction);
                 menuExt.addAction(KDevelop::ContextMenuExtension::RunGroup, m_runTestsAction);
+                menuExt.addAction(KDevelop::ContextMenuExtension::RunGroup, m_runTestSuitesAction);
+                m_rerunFailedTestsAction->disconnect();
+                connect(m_rerunFailedTestsAction, &QAction::triggered, this, [this, item](){
+                    runBuildTestsJob(item, RerunFailedTests);
+                });
+                menuExt.addAction(KDevelop::ContextMenuExtension::RunGroup, m_runAffectedTestsAction);
+                menuExt.addAction(KDevelop::ContextMenuExtension::RunGroup, m_rerunFailedTestsAction);
+
+                m_buildBenchmarksAction->disconnect();
+                connect(m_buildBenchmarksAction, &QAction::triggered, this, [this, item](){
+                    runBuildBenchmarksJob(item, false);
+                });
+                m_runBenchmarksAction->disconnect();
+                connect(m_runBenchmarksAction, &QAction::triggered, this, [this, item](){
+                    runBuildBenchmarksJob(item, true);
+                });
+                menuExt.addAction(KDevelop::ContextMenuExtension::RunGroup, m_buildBenchmarksAction);
+                menuExt.addAction(KDevelop::ContextMenuExtension::RunGroup, m_runBenchmarksAction);
+
+                if (item->isProjectRoot())
+                {
+                    m_repeatTestsAction->disconnect();
+                    connect(m_repeatTestsAction, &QAction::triggered, this, [this, item](){
+                        repeatTests(item->project());
+                    });
+                    menuExt.addAction(KDevelop::ContextMenuExtension::RunGroup, m_repeatTestsAction);
+
+                    m_testTimesAction->disconnect();
+                    connect(m_testTimesAction, &QAction::triggered, this, [this, item](){
+                        auto dialog = new CargoTestTimesDialog(CargoTestHistory(CargoTestHistory::fileName(item->project())),
+                                                               QApplication::activeWindow());
+                        dialog->setRunReport(m_testScheduler->lastRunReport());
+                        dialog->setAttribute(Qt::WA_DeleteOnClose);
+                        dialog->show();
+                    });
+                    menuExt.addAction(KDevelop::ContextMenuExtension::RunGroup, m_testTimesAction);
+
+                    m_benchmarkResultsAction->disconnect();
+                    connect(m_benchmarkResultsAction, &QAction::triggered, this, [item](){
+                        auto dialog = new CargoBenchmarkResultsDialog(CargoBenchmarkResults(CargoBenchmarkResults::fileName(item->project())),
+                                                                      QApplication::activeWindow());
+                        dialog->setAttribute(Qt::WA_DeleteOnClose);
+                        dialog->show();
+                    });
+                    menuExt.addAction(KDevelop::ContextMenuExtension::RunGroup, m_benchmarkResultsAction);
+                }
             }
         }
     }
@@ -300,26 +651,134 @@ KDevelop::ContextMenuExtension CargoPlugin::contextMenuExtension(KDevelop::Conte
     return menuExt;
 }
 
-void CargoPlugin::runBuildTestsJob(KDevelop::ProjectBaseItem* item, bool run)
+void CargoPlugin::runBuildTestsJob(KDevelop::ProjectBaseItem* item, TestsMode mode)
 {
     CargoBuildJob* job = new CargoBuildJob(this, item, QStringLiteral("test"));
-    if (run)
+    job->setJsonDiagnostics(true);
+
+    Path packageDir;
+    QStringList arguments = packageArguments(item, true, &packageDir);
+    if (arguments.isEmpty())
+    {
+        arguments << QStringLiteral("--all");
+    }
+    else
     {
-        job->setRunArguments({ QStringLiteral("--all") });
+        job->setDiagnosticsScope(packageDir);
+    }
+
+    if (mode == RunTests)
+    {
+        job->setRunArguments(arguments);
         job->setStandardViewType(KDevelop::IOutputView::RunView);
     }
     else
     {
-        job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
+        job->setRunArguments(arguments << QStringLiteral("--no-run"));
         job->setStandardViewType(KDevelop::IOutputView::BuildView);
     }
 
-    connect(job, &KJob::finished, [this, item](){
+    connect(job, &KJob::finished, [this, item, job, mode](){
         CargoFindTestsJob* findTestsJob = new CargoFindTestsJob(this, item);
+        if (!job->error())
+        {
+            if (mode == RunTestSuites)
+            {
+                findTestsJob->setRunAfterFinding(CargoFindTestsJob::RunAllSuites);
+            }
+            else if (mode == RunAffectedTests)
+            {
+                findTestsJob->setRunAfterFinding(CargoFindTestsJob::RunAffectedSuites);
+            }
+            else if (mode == RerunFailedTests)
+            {
+                findTestsJob->setRunAfterFinding(CargoFindTestsJob::RunFailedCases);
+            }
+        }
+
+        // The build reports every test executable it made or found up to date, wherever they are
+        QMap<QString, QString> executables;
+        for (const auto& artifact : job->artifacts())
+        {
+            if (artifact.test && artifact.executable.isValid())
+            {
+                executables.insert(artifact.executable.toLocalFile(), CargoFindTestsJob::qualifiedSuiteName(artifact));
+            }
+        }
+        if (!executables.isEmpty())
+        {
+            findTestsJob->setTestExecutables(executables);
+        }
+
         core()->runController()->registerJob(findTestsJob);
     });
 
     core()->runController()->registerJob(job);
 }
 
+void CargoPlugin::runBuildBenchmarksJob(KDevelop::ProjectBaseItem* item, bool run)
+{
+    CargoBuildJob* job = new CargoBuildJob(this, item, QStringLiteral("bench"));
+    job->setJsonDiagnostics(true);
+
+    Path packageDir;
+    QStringList arguments = packageArguments(item, true, &packageDir);
+    if (arguments.isEmpty())
+    {
+        arguments << QStringLiteral("--all");
+    }
+    else
+    {
+        job->setDiagnosticsScope(packageDir);
+    }
+
+    // The benchmarks are run from the test view, one at a time, so that their estimates are recorded
+    job->setRunArguments(arguments << QStringLiteral("--no-run"));
+    job->setStandardViewType(KDevelop::IOutputView::BuildView);
+
+    connect(job, &KJob::finished, [this, item, job, run](){
+        CargoFindBenchmarksJob* findBenchmarksJob = new CargoFindBenchmarksJob(this, item->project());
+        findBenchmarksJob->setRunAfterFinding(run && !job->error());
+
+        // Libraries and binaries are built as benchmark harnesses too, they are only registered if they have benchmarks
+        QMap<QString, QString> executables;
+        for (const auto& artifact : job->artifacts())
+        {
+            if (artifact.test && artifact.executable.isValid())
+            {
+                executables.insert(artifact.executable.toLocalFile(), CargoFindTestsJob::qualifiedSuiteName(artifact));
+            }
+        }
+        if (!executables.isEmpty())
+        {
+            findBenchmarksJob->setBenchmarkExecutables(executables);
+        }
+
+        core()->runController()->registerJob(findBenchmarksJob);
+    });
+
+    core()->runController()->registerJob(job);
+}
+
+void CargoPlugin::repeatTests(KDevelop::IProject* project)
+{
+    CargoRepeatTestsDialog dialog(project, QApplication::activeWindow());
+    if (dialog.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+
+    // Suites are looked up again, as they may have been replaced while the dialog was shown
+    const QHash<QString, QStringList> selected = dialog.selectedCases();
+    for (auto it = selected.constBegin(); it != selected.constEnd(); ++it)
+    {
+        KDevelop::ITestSuite* suite = core()->testController()->findTestSuite(project, it.key());
+        KJob* job = suite ? CargoFindTestsJob::launchRepeatedCases(suite, it.value(), dialog.repetitions(), dialog.stopOnFailure()) : nullptr;
+        if (job)
+        {
+            core()->runController()->registerJob(job);
+        }
+    }
+}
+
 #include "cargoplugin.moc"
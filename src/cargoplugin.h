@@ -33,6 +33,11 @@
 class KConfigGroup;
 class KDialogBase;
 class CargoExecutionConfigType;
+class CargoProblemReporter;
+class CargoMetadata;
+class CargoTestScheduler;
+class CargoDepInfoIndex;
+struct CargoWorkspace;
 
 namespace KDevelop
 {
@@ -70,6 +75,8 @@ signals:
 // AbstractFileManagerPlugin API
 public:
     Features features() const override;
+    KDevelop::ProjectFolderItem* import( KDevelop::IProject* project ) override;
+    bool isValid( const KDevelop::Path& path, const bool isFolder, KDevelop::IProject* project ) const override;
     virtual KDevelop::ProjectFolderItem* createFolderItem( KDevelop::IProject* project, 
                     const KDevelop::Path& path, KDevelop::ProjectBaseItem* parent = nullptr ) override;
 
@@ -112,12 +119,75 @@ public:
 // IPlugin API
     void unload() override;
 
+    /// Publishes diagnostics of builds in the Problems tool view, may be null after unload()
+    CargoProblemReporter* problemReporter() const { return m_problemReporter; }
+
+    /// Runs the test executables of all Cargo projects
+    CargoTestScheduler* testScheduler() const { return m_testScheduler; }
+
+    /// @return the target directory of @p project from cargo metadata, which honours CARGO_TARGET_DIR and build.target-dir
+    KDevelop::Path targetDirectory(KDevelop::IProject* project) const;
+
+    /// @return the directory in the target directory of @p project where caches and logs are kept
+    static QString dataDirectory(KDevelop::IProject* project);
+
+    /// Maps sources to the test executables of @p project, null if the project is not open
+    CargoDepInfoIndex* depInfoIndex(KDevelop::IProject* project) const { return m_depInfoIndexes.value(project); }
+
 private:
-    void runBuildTestsJob(KDevelop::ProjectBaseItem* item, bool run);
+    enum TestsMode
+    {
+        BuildTests,
+        RunTests,
+        /// Builds the tests, and runs all of their suites on the shared test scheduler
+        RunTestSuites,
+        /// Builds the tests, and runs the suites affected by changes since they last passed
+        RunAffectedTests,
+        /// Builds the tests, and runs the cases that failed the last time they were run
+        RerunFailedTests
+    };
+
+    void runBuildTestsJob(KDevelop::ProjectBaseItem* item, TestsMode mode);
+
+    /// Builds the benchmarks with `cargo bench --no-run`, registers their suites, and runs them if @p run is set
+    void runBuildBenchmarksJob(KDevelop::ProjectBaseItem* item, bool run);
+
+    /// Asks which cases of @p project to repeat, and how often, and runs them
+    void repeatTests(KDevelop::IProject* project);
+
+    /**
+     * Returns the cargo arguments that restrict a command to the workspace member containing @p item,
+     * and to the target containing it if @p withTarget is set and there is one.
+     * Returns an empty list for the project root, which stands for the whole workspace.
+     *
+     * @param packageDir set to the directory of the package, if there is one
+     */
+    QStringList packageArguments(KDevelop::ProjectBaseItem* item, bool withTarget, KDevelop::Path* packageDir = nullptr) const;
+    bool isPackageFolder(KDevelop::ProjectBaseItem* item) const;
+
+    /// Replaces the targets of package folders in @p folder and its subfolders with those in @p workspace
+    void updateTargets(KDevelop::ProjectFolderItem* folder, const CargoWorkspace& workspace);
 
     CargoExecutionConfigType* m_configType;
+    QAction* m_buildPackageAction;
     QAction* m_buildTestsAction;
     QAction* m_runTestsAction;
+    QAction* m_runTestSuitesAction;
+    QAction* m_runAffectedTestsAction;
+    QAction* m_rerunFailedTestsAction;
+    QAction* m_repeatTestsAction;
+    QAction* m_testTimesAction;
+    QAction* m_buildBenchmarksAction;
+    QAction* m_runBenchmarksAction;
+    QAction* m_benchmarkResultsAction;
+    CargoProblemReporter* m_problemReporter;
+    CargoTestScheduler* m_testScheduler;
+    CargoMetadata* m_metadata;
+
+    /// Target directories of open projects, which are never imported
+    QHash<KDevelop::IProject*, KDevelop::Path> m_targetDirectories;
+
+    QHash<KDevelop::IProject*, CargoDepInfoIndex*> m_depInfoIndexes;
 };
 
 #endif
@@ -0,0 +1,207 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargoproblemreporter.h"
+
+#include <KLocalizedString>
+#include <KTextEditor/Range>
+
+#include <interfaces/icore.h>
+#include <interfaces/ilanguagecontroller.h>
+#include <kdevplatform_version.h>
+#include <language/editor/documentrange.h>
+#include <shell/problem.h>
+#include <shell/problemmodel.h>
+#include <shell/problemmodelset.h>
+
+using namespace KDevelop;
+
+namespace
+{
+
+const QString ModelId = QStringLiteral("Cargo");
+
+IProblem::Severity severityForLevel(const QString& level)
+{
+    if (level.startsWith(QStringLiteral("error")))
+    {
+        return IProblem::Error;
+    }
+    else if (level == QStringLiteral("warning"))
+    {
+        return IProblem::Warning;
+    }
+    return IProblem::Hint;
+}
+
+/// Identifies a diagnostic within its file
+QString diagnosticKey(const CargoDiagnostic& diagnostic)
+{
+    return QStringLiteral("%1:%2:%3:%4:%5:%6").arg(diagnostic.level)
+                                              .arg(diagnostic.line).arg(diagnostic.column)
+                                              .arg(diagnostic.endLine).arg(diagnostic.endColumn)
+                                              .arg(diagnostic.message);
+}
+
+IProblem::Ptr createProblem(const CargoDiagnostic& diagnostic)
+{
+    IProblem::Ptr problem(new DetectedProblem());
+    problem->setSource(IProblem::Plugin);
+    problem->setSeverity(severityForLevel(diagnostic.level));
+    problem->setDescription(diagnostic.message);
+    problem->setExplanation(diagnostic.rendered.trimmed());
+    problem->setFinalLocation(DocumentRange(IndexedString(diagnostic.file.toUrl()),
+                                            KTextEditor::Range(diagnostic.line, diagnostic.column,
+                                                               diagnostic.endLine, diagnostic.endColumn)));
+    return problem;
+}
+
+}
+
+CargoProblemReporter::CargoProblemReporter(QObject* parent)
+    : QObject(parent)
+    , m_model(new ProblemModel(this))
+    , m_nextBuild(0)
+{
+    m_model->setFeatures(ProblemModel::ScopeFilter | ProblemModel::SeverityFilter
+                         | ProblemModel::Grouping | ProblemModel::CanByPassScopeFilter);
+
+    ProblemModelSet* models = ICore::self()->languageController()->problemModelSet();
+#if KDEVPLATFORM_VERSION >= QT_VERSION_CHECK(5, 1, 40)
+    models->addModel(ModelId, i18n("Cargo"), m_model);
+#else
+    models->addModel(ModelId, m_model);
+#endif
+}
+
+CargoProblemReporter::~CargoProblemReporter()
+{
+    if (ICore::self())
+    {
+        ICore::self()->languageController()->problemModelSet()->removeModel(ModelId);
+    }
+}
+
+ProblemModel* CargoProblemReporter::model() const
+{
+    return m_model;
+}
+
+QVector<IProblem::Ptr> CargoProblemReporter::problems() const
+{
+    QVector<IProblem::Ptr> problems;
+    for (const auto& file : m_files)
+    {
+        for (const auto& problem : file)
+        {
+            problems << problem;
+        }
+    }
+    return problems;
+}
+
+int CargoProblemReporter::beginBuild(const Path& buildDir)
+{
+    const int build = m_nextBuild++;
+    m_builds[build].buildDir = buildDir;
+    return build;
+}
+
+void CargoProblemReporter::addDiagnostics(int build, const QVector<CargoDiagnostic>& diagnostics)
+{
+    auto buildIt = m_builds.find(build);
+    if (buildIt == m_builds.end())
+    {
+        return;
+    }
+
+    for (const auto& diagnostic : diagnostics)
+    {
+        const IndexedString file(diagnostic.file.toUrl());
+        const QString key = diagnosticKey(diagnostic);
+        buildIt->reported[file].insert(key);
+
+        auto& known = m_files[file];
+        if (known.contains(key))
+        {
+            continue;
+        }
+
+        // New diagnostics are appended without touching the rest of the model
+        const IProblem::Ptr problem = createProblem(diagnostic);
+        known.insert(key, problem);
+        m_model->addProblem(problem);
+    }
+}
+
+void CargoProblemReporter::endBuild(int build, bool complete)
+{
+    const Build finished = m_builds.take(build);
+    if (!complete)
+    {
+        return;
+    }
+
+    // Files outside of the build directory belong to other projects, and are left alone
+    bool removed = false;
+    for (auto it = m_files.begin(); it != m_files.end();)
+    {
+        if (!finished.buildDir.isParentOf(Path(it.key().toUrl())))
+        {
+            ++it;
+            continue;
+        }
+
+        const QSet<QString> reported = finished.reported.value(it.key());
+        auto& known = it.value();
+        for (auto problemIt = known.begin(); problemIt != known.end();)
+        {
+            if (reported.contains(problemIt.key()))
+            {
+                ++problemIt;
+            }
+            else
+            {
+                problemIt = known.erase(problemIt);
+                removed = true;
+            }
+        }
+
+        if (known.isEmpty())
+        {
+            it = m_files.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    /*
+     * The problem model can only remove problems by replacing all of them,
+     * so this is only done once per build, and only if something was fixed.
+     */
+    if (removed)
+    {
+        m_model->setProblems(problems());
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOPROBLEMREPORTER_H
+#define CARGOPROBLEMREPORTER_H
+
+#include <interfaces/iproblem.h>
+#include <serialization/indexedstring.h>
+#include <util/path.h>
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QVector>
+
+#include "cargomessageparser.h"
+
+namespace KDevelop
+{
+class ProblemModel;
+}
+
+/**
+ * Publishes compiler diagnostics from cargo builds in the Problems tool view.
+ *
+ * Diagnostics are added as soon as they are parsed, and duplicates are dropped,
+ * because cargo reports the same warning once for every target that includes the file.
+ * When a build completes, diagnostics that it did not report again are removed,
+ * which is the only time the whole model has to be reset.
+ */
+class CargoProblemReporter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CargoProblemReporter(QObject* parent = nullptr);
+    ~CargoProblemReporter() override;
+
+    /**
+     * Starts collecting diagnostics of a build in @p buildDir.
+     *
+     * @return an identifier for the other calls about this build
+     */
+    int beginBuild(const KDevelop::Path& buildDir);
+
+    void addDiagnostics(int build, const QVector<CargoDiagnostic>& diagnostics);
+
+    /**
+     * Finishes the build.
+     *
+     * If it was @p complete, stale diagnostics from files in its build directory are removed.
+     * Interrupted builds only ever add diagnostics.
+     */
+    void endBuild(int build, bool complete);
+
+    KDevelop::ProblemModel* model() const;
+    QVector<KDevelop::IProblem::Ptr> problems() const;
+
+private:
+    struct Build
+    {
+        KDevelop::Path buildDir;
+        QHash<KDevelop::IndexedString, QSet<QString>> reported;
+    };
+
+    KDevelop::ProblemModel* m_model;
+    /// Published problems of each file, by a key that identifies duplicates
+    QHash<KDevelop::IndexedString, QHash<QString, KDevelop::IProblem::Ptr>> m_files;
+    QHash<int, Build> m_builds;
+    int m_nextBuild;
+};
+
+#endif
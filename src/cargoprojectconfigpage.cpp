@@ -0,0 +1,65 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargoprojectconfigpage.h"
+#include "ui_cargoprojectconfig.h"
+
+#include <KLocalizedString>
+
+#include <QIcon>
+#include <QVBoxLayout>
+
+CargoProjectConfigPage::CargoProjectConfigPage(KDevelop::IPlugin* plugin, const KDevelop::ProjectConfigOptions& options, QWidget* parent)
+    : ProjectConfigPage<CargoSettings>(plugin, options, parent)
+    , m_ui(new Ui::CargoProjectConfig)
+{
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    QWidget* widget = new QWidget;
+    m_ui->setupUi(widget);
+    layout->addWidget(widget);
+
+    m_ui->kcfg_outputLines->setEnabled(m_ui->kcfg_limitOutput->isChecked());
+    connect(m_ui->kcfg_limitOutput, &QCheckBox::toggled, m_ui->kcfg_outputLines, &QWidget::setEnabled);
+
+    m_ui->kcfg_checkDelay->setEnabled(m_ui->kcfg_checkOnSave->isChecked());
+    connect(m_ui->kcfg_checkOnSave, &QCheckBox::toggled, m_ui->kcfg_checkDelay, &QWidget::setEnabled);
+}
+
+CargoProjectConfigPage::~CargoProjectConfigPage()
+{
+    delete m_ui;
+}
+
+QString CargoProjectConfigPage::name() const
+{
+    return i18n("Cargo");
+}
+
+QString CargoProjectConfigPage::fullName() const
+{
+    return i18n("Configure Cargo Settings");
+}
+
+QIcon CargoProjectConfigPage::icon() const
+{
+    return QIcon::fromTheme(QStringLiteral("cargo"));
+}
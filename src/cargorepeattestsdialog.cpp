@@ -0,0 +1,111 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargorepeattestsdialog.h"
+
+#include <QCheckBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QSpinBox>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include <KLocalizedString>
+
+#include <interfaces/icore.h>
+#include <interfaces/itestcontroller.h>
+#include <interfaces/itestsuite.h>
+
+#include "cargofindtestsjob.h"
+
+using namespace KDevelop;
+
+CargoRepeatTestsDialog::CargoRepeatTestsDialog(IProject* project, QWidget* parent)
+ : QDialog(parent)
+ , m_tree(new QTreeWidget(this))
+ , m_repetitions(new QSpinBox(this))
+ , m_stopOnFailure(new QCheckBox(i18n("Stop at the first failure"), this))
+{
+    setWindowTitle(i18n("Repeat Cargo Tests"));
+
+    m_tree->setHeaderHidden(true);
+    for (ITestSuite* suite : ICore::self()->testController()->testSuitesForProject(project))
+    {
+        const QStringList failed = CargoFindTestsJob::failedCases(suite);
+
+        auto suiteItem = new QTreeWidgetItem(m_tree, { suite->name() });
+        suiteItem->setFlags(suiteItem->flags() | Qt::ItemIsUserCheckable | Qt::ItemIsAutoTristate);
+        for (const auto& caseName : suite->cases())
+        {
+            auto caseItem = new QTreeWidgetItem(suiteItem, { caseName });
+            caseItem->setFlags(caseItem->flags() | Qt::ItemIsUserCheckable);
+            caseItem->setCheckState(0, failed.contains(caseName) ? Qt::Checked : Qt::Unchecked);
+        }
+        suiteItem->setExpanded(!failed.isEmpty());
+    }
+    m_tree->sortItems(0, Qt::AscendingOrder);
+
+    m_repetitions->setRange(2, 1000);
+    m_repetitions->setValue(DefaultRepetitions);
+
+    auto options = new QFormLayout;
+    options->addRow(i18n("Repetitions:"), m_repetitions);
+    options->addRow(m_stopOnFailure);
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(m_tree);
+    layout->addLayout(options);
+    layout->addWidget(buttons);
+
+    resize(600, 500);
+}
+
+QHash<QString, QStringList> CargoRepeatTestsDialog::selectedCases() const
+{
+    QHash<QString, QStringList> selected;
+    for (int i = 0; i < m_tree->topLevelItemCount(); ++i)
+    {
+        const QTreeWidgetItem* suiteItem = m_tree->topLevelItem(i);
+        for (int j = 0; j < suiteItem->childCount(); ++j)
+        {
+            if (suiteItem->child(j)->checkState(0) == Qt::Checked)
+            {
+                selected[suiteItem->text(0)] << suiteItem->child(j)->text(0);
+            }
+        }
+    }
+    return selected;
+}
+
+int CargoRepeatTestsDialog::repetitions() const
+{
+    return m_repetitions->value();
+}
+
+bool CargoRepeatTestsDialog::stopOnFailure() const
+{
+    return m_stopOnFailure->isChecked();
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOREPEATTESTSDIALOG_H
+#define CARGOREPEATTESTSDIALOG_H
+
+#include <QDialog>
+#include <QHash>
+#include <QStringList>
+
+class QCheckBox;
+class QSpinBox;
+class QTreeWidget;
+
+namespace KDevelop
+{
+class IProject;
+}
+
+/**
+ * Asks which test cases of a project to repeat, how often, and whether to stop at the first failure.
+ *
+ * Cases that failed the last time they were run are selected initially.
+ */
+class CargoRepeatTestsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    enum { DefaultRepetitions = 10 };
+
+    explicit CargoRepeatTestsDialog(KDevelop::IProject* project, QWidget* parent = nullptr);
+
+    /// @return the selected cases, by suite name
+    QHash<QString, QStringList> selectedCases() const;
+
+    int repetitions() const;
+    bool stopOnFailure() const;
+
+private:
+    QTreeWidget* m_tree;
+    QSpinBox* m_repetitions;
+    QCheckBox* m_stopOnFailure;
+};
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargostackdump.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include "debug.h"
+
+namespace
+{
+
+QString readProcFile(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QString();
+    }
+    return QString::fromLocal8Bit(file.readAll()).trimmed();
+}
+
+}
+
+CargoStackDump::CargoStackDump(qint64 pid, QObject* parent)
+ : QObject(parent)
+ , m_pid(pid)
+ , m_gdb(nullptr)
+ , m_timer(nullptr)
+ , m_finished(false)
+{
+}
+
+CargoStackDump::~CargoStackDump()
+{
+}
+
+void CargoStackDump::start()
+{
+    const QString gdb = QStandardPaths::findExecutable(QStringLiteral("gdb"));
+    if (gdb.isEmpty())
+    {
+        finish(procStacks(m_pid));
+        return;
+    }
+
+    m_gdb = new QProcess(this);
+    m_gdb->setProgram(gdb);
+    m_gdb->setArguments({ QStringLiteral("-p"), QString::number(m_pid), QStringLiteral("-batch"), QStringLiteral("-nx"),
+                          QStringLiteral("-ex"), QStringLiteral("thread apply all bt") });
+    m_gdb->setProcessChannelMode(QProcess::MergedChannels);
+
+    connect(m_gdb, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, &CargoStackDump::gdbFinished);
+    connect(m_gdb, static_cast<void(QProcess::*)(QProcess::ProcessError)>(&QProcess::error), this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+        {
+            finish(procStacks(m_pid));
+        }
+    });
+
+    // gdb can take long to load the symbols of a large test executable
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, [this]() {
+        qCDebug(KDEV_CARGO) << "gdb did not finish a stack dump of" << m_pid << "in time";
+        m_gdb->disconnect(this);
+        m_gdb->kill();
+        finish(procStacks(m_pid));
+    });
+    m_timer->start(GdbTimeout);
+
+    m_gdb->start();
+}
+
+void CargoStackDump::gdbFinished(int code, QProcess::ExitStatus status)
+{
+    const QString output = QString::fromLocal8Bit(m_gdb->readAll());
+
+    // Without any backtrace, gdb could not attach, usually because ptrace is restricted
+    if (status != QProcess::NormalExit || !output.contains(QLatin1String("#0")))
+    {
+        qCDebug(KDEV_CARGO) << "gdb could not dump the stacks of" << m_pid << code << output;
+        finish(procStacks(m_pid));
+        return;
+    }
+    finish(output);
+}
+
+void CargoStackDump::finish(const QString& dump)
+{
+    if (m_finished)
+    {
+        return;
+    }
+    m_finished = true;
+
+    emit finished(dump);
+    deleteLater();
+}
+
+QString CargoStackDump::procStacks(qint64 pid)
+{
+    const QString procDir = QStringLiteral("/proc/%1/task").arg(pid);
+    const QStringList tasks = QDir(procDir).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    if (tasks.isEmpty())
+    {
+        return QString();
+    }
+
+    QStringList dump;
+    for (const auto& task : tasks)
+    {
+        const QString taskDir = procDir + QLatin1Char('/') + task;
+
+        // The state is the first field after the command name, which is in parentheses and may contain spaces
+        const QString stat = readProcFile(taskDir + QStringLiteral("/stat"));
+        const QString state = stat.mid(stat.lastIndexOf(QLatin1Char(')')) + 2, 1);
+
+        dump << QStringLiteral("Thread %1 (%2) state %3, waiting in %4")
+                    .arg(task, readProcFile(taskDir + QStringLiteral("/comm")), state, readProcFile(taskDir + QStringLiteral("/wchan")));
+
+        const QString stack = readProcFile(taskDir + QStringLiteral("/stack"));
+        if (!stack.isEmpty())
+        {
+            dump << stack;
+        }
+    }
+    return dump.join(QLatin1Char('\n'));
+}
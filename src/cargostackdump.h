@@ -0,0 +1,68 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOSTACKDUMP_H
+#define CARGOSTACKDUMP_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+
+class QTimer;
+
+/**
+ * Captures the stacks of all threads of a running process, such as a test that hangs.
+ *
+ * gdb is attached in batch mode to print a backtrace of every thread. If gdb is not installed,
+ * cannot attach or takes longer than GdbTimeout milliseconds, the state of each thread is read
+ * from /proc instead, which has kernel stacks only where the system allows reading them.
+ *
+ * The dump deletes itself once it emitted finished().
+ */
+class CargoStackDump : public QObject
+{
+    Q_OBJECT
+public:
+    enum { GdbTimeout = 20000 };
+
+    explicit CargoStackDump(qint64 pid, QObject* parent = nullptr);
+    ~CargoStackDump() override;
+
+    void start();
+
+    /// @return the state and kernel stack of each thread of process @p pid, as far as /proc shows them
+    static QString procStacks(qint64 pid);
+
+signals:
+    void finished(const QString& dump);
+
+private:
+    void gdbFinished(int code, QProcess::ExitStatus status);
+    void finish(const QString& dump);
+
+    qint64 m_pid;
+    QProcess* m_gdb;
+    QTimer* m_timer;
+    bool m_finished;
+};
+
+#endif
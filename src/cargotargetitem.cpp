@@ -0,0 +1,101 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargotargetitem.h"
+
+using namespace KDevelop;
+
+CargoTargetItem::CargoTargetItem(const QString& package, const CargoTarget& target)
+    : m_package(package)
+    , m_target(target)
+{
+}
+
+CargoTargetItem::~CargoTargetItem()
+{
+}
+
+QString CargoTargetItem::packageName() const
+{
+    return m_package;
+}
+
+const CargoTarget& CargoTargetItem::cargoTarget() const
+{
+    return m_target;
+}
+
+ProjectTargetItem* CargoTargetItem::create(IProject* project, const CargoWorkspace& workspace,
+                                           const CargoPackage& package, const CargoTarget& target,
+                                           ProjectBaseItem* parent)
+{
+    ProjectTargetItem* item = nullptr;
+    if (target.kind == CargoTarget::Library)
+    {
+        item = new CargoLibraryTargetItem(project, package.name, target, parent);
+    }
+    else
+    {
+        /*
+         * Tests and benches are built into target/debug/deps with a hash in their file name,
+         * which cannot be known in advance.
+         */
+        QUrl builtUrl;
+        if (target.kind == CargoTarget::Binary)
+        {
+            builtUrl = Path(workspace.targetDirectory, QStringLiteral("debug/") + target.name).toUrl();
+        }
+        else if (target.kind == CargoTarget::Example)
+        {
+            builtUrl = Path(workspace.targetDirectory, QStringLiteral("debug/examples/") + target.name).toUrl();
+        }
+        item = new CargoExecutableTargetItem(project, package.name, target, builtUrl, parent);
+    }
+
+    new ProjectFileItem(project, target.sourcePath, item);
+    return item;
+}
+
+CargoLibraryTargetItem::CargoLibraryTargetItem(IProject* project, const QString& package, const CargoTarget& target,
+                                               ProjectBaseItem* parent)
+    : ProjectLibraryTargetItem(project, target.name, parent)
+    , CargoTargetItem(package, target)
+{
+}
+
+CargoExecutableTargetItem::CargoExecutableTargetItem(IProject* project, const QString& package, const CargoTarget& target,
+                                                     const QUrl& builtUrl, ProjectBaseItem* parent)
+    : ProjectExecutableTargetItem(project, target.name, parent)
+    , CargoTargetItem(package, target)
+    , m_builtUrl(builtUrl)
+{
+}
+
+QUrl CargoExecutableTargetItem::builtUrl() const
+{
+    return m_builtUrl;
+}
+
+QUrl CargoExecutableTargetItem::installedUrl() const
+{
+    return QUrl();
+}
@@ -0,0 +1,75 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOTARGETITEM_H
+#define CARGOTARGETITEM_H
+
+#include <project/projectmodel.h>
+
+#include "cargometadata.h"
+
+/**
+ * Common part of the project items for targets of cargo packages.
+ */
+class CargoTargetItem
+{
+public:
+    CargoTargetItem(const QString& package, const CargoTarget& target);
+    virtual ~CargoTargetItem();
+
+    QString packageName() const;
+    const CargoTarget& cargoTarget() const;
+
+    /**
+     * Creates the item for @p target in @p parent, the folder of the package.
+     * Targets are shown with their source file inside them.
+     */
+    static KDevelop::ProjectTargetItem* create(KDevelop::IProject* project, const CargoWorkspace& workspace,
+                                               const CargoPackage& package, const CargoTarget& target,
+                                               KDevelop::ProjectBaseItem* parent);
+
+private:
+    QString m_package;
+    CargoTarget m_target;
+};
+
+class CargoLibraryTargetItem : public KDevelop::ProjectLibraryTargetItem, public CargoTargetItem
+{
+public:
+    CargoLibraryTargetItem(KDevelop::IProject* project, const QString& package, const CargoTarget& target,
+                           KDevelop::ProjectBaseItem* parent);
+};
+
+class CargoExecutableTargetItem : public KDevelop::ProjectExecutableTargetItem, public CargoTargetItem
+{
+public:
+    CargoExecutableTargetItem(KDevelop::IProject* project, const QString& package, const CargoTarget& target,
+                              const QUrl& builtUrl, KDevelop::ProjectBaseItem* parent);
+
+    QUrl builtUrl() const override;
+    QUrl installedUrl() const override;
+
+private:
+    QUrl m_builtUrl;
+};
+
+#endif
@@ -0,0 +1,230 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargotestcasetree.h"
+
+#include <QVarLengthArray>
+
+namespace
+{
+
+const QLatin1String ModuleSeparator("::");
+
+}
+
+CargoTestCaseTree::CargoTestCaseTree()
+ : m_nodes({ Node{ -1, -1, 0 } })
+ , m_ignoredCount(0)
+{
+}
+
+void CargoTestCaseTree::addCase(const QString& caseName)
+{
+    addCaseNode(caseName);
+}
+
+void CargoTestCaseTree::addIgnoredCase(const QString& caseName)
+{
+    Node& node = m_nodes[addCaseNode(caseName)];
+    if (!(node.flags & IsIgnored))
+    {
+        node.flags |= IsIgnored;
+        ++m_ignoredCount;
+    }
+}
+
+int CargoTestCaseTree::addCaseNode(const QString& caseName)
+{
+    const int node = insertNode(caseName);
+    if (!(m_nodes[node].flags & IsCase))
+    {
+        m_nodes[node].flags |= IsCase;
+        m_cases << node;
+    }
+    return node;
+}
+
+bool CargoTestCaseTree::contains(const QString& caseName) const
+{
+    return findNode(caseName) != -1;
+}
+
+bool CargoTestCaseTree::isIgnored(const QString& caseName) const
+{
+    const int node = findNode(caseName);
+    return node != -1 && (m_nodes[node].flags & IsIgnored);
+}
+
+QString CargoTestCaseTree::caseAt(int index) const
+{
+    return nodeName(m_cases[index]);
+}
+
+bool CargoTestCaseTree::isIgnoredAt(int index) const
+{
+    return m_nodes[m_cases[index]].flags & IsIgnored;
+}
+
+QStringList CargoTestCaseTree::cases() const
+{
+    QStringList cases;
+    cases.reserve(m_cases.size());
+    for (int node : m_cases)
+    {
+        cases << nodeName(node);
+    }
+    return cases;
+}
+
+QStringList CargoTestCaseTree::ignoredCases() const
+{
+    QStringList cases;
+    cases.reserve(m_ignoredCount);
+    for (int node : m_cases)
+    {
+        if (m_nodes[node].flags & IsIgnored)
+        {
+            cases << nodeName(node);
+        }
+    }
+    return cases;
+}
+
+void CargoTestCaseTree::squeeze()
+{
+    m_segments.squeeze();
+    m_segmentIds.squeeze();
+    m_nodes.squeeze();
+    m_children.squeeze();
+    m_cases.squeeze();
+}
+
+bool CargoTestCaseTree::operator==(const CargoTestCaseTree& other) const
+{
+    if (size() != other.size() || ignoredCount() != other.ignoredCount())
+    {
+        return false;
+    }
+
+    for (int node : m_cases)
+    {
+        const int otherNode = other.findNode(nodeName(node));
+        if (otherNode == -1 || (other.m_nodes[otherNode].flags & IsIgnored) != (m_nodes[node].flags & IsIgnored))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int CargoTestCaseTree::findNode(const QString& caseName) const
+{
+    int node = 0;
+    int start = 0;
+    while (true)
+    {
+        const int end = caseName.indexOf(ModuleSeparator, start);
+        const int length = (end == -1 ? caseName.size() : end) - start;
+
+        // Only looked up, so the segment can refer to the characters of the name instead of a copy
+        const QString segment = QString::fromRawData(caseName.constData() + start, length);
+        const auto segmentIt = m_segmentIds.constFind(segment);
+        if (segmentIt == m_segmentIds.constEnd())
+        {
+            return -1;
+        }
+
+        const auto childIt = m_children.constFind(childKey(node, segmentIt.value()));
+        if (childIt == m_children.constEnd())
+        {
+            return -1;
+        }
+        node = childIt.value();
+
+        if (end == -1)
+        {
+            return (m_nodes[node].flags & IsCase) ? node : -1;
+        }
+        start = end + ModuleSeparator.size();
+    }
+}
+
+int CargoTestCaseTree::insertNode(const QString& caseName)
+{
+    int node = 0;
+    int start = 0;
+    while (true)
+    {
+        const int end = caseName.indexOf(ModuleSeparator, start);
+        const int length = (end == -1 ? caseName.size() : end) - start;
+
+        const QString segment = QString::fromRawData(caseName.constData() + start, length);
+        int segmentId = m_segmentIds.value(segment, -1);
+        if (segmentId == -1)
+        {
+            // The interned copy must not refer to the name, which may go away
+            segmentId = m_segments.size();
+            m_segments << QString(segment.constData(), segment.size());
+            m_segmentIds.insert(m_segments.last(), segmentId);
+        }
+
+        const quint64 key = childKey(node, segmentId);
+        int child = m_children.value(key, -1);
+        if (child == -1)
+        {
+            child = m_nodes.size();
+            m_nodes << Node{ node, segmentId, 0 };
+            m_children.insert(key, child);
+        }
+        node = child;
+
+        if (end == -1)
+        {
+            return node;
+        }
+        start = end + ModuleSeparator.size();
+    }
+}
+
+QString CargoTestCaseTree::nodeName(int node) const
+{
+    QVarLengthArray<int, 16> path;
+    int length = 0;
+    for (int n = node; n > 0; n = m_nodes[n].parent)
+    {
+        path.append(m_nodes[n].segment);
+        length += m_segments[m_nodes[n].segment].size();
+    }
+    length += (path.size() - 1) * ModuleSeparator.size();
+
+    QString name;
+    name.reserve(length);
+    for (int i = path.size() - 1; i >= 0; --i)
+    {
+        name += m_segments[path[i]];
+        if (i > 0)
+        {
+            name += ModuleSeparator;
+        }
+    }
+    return name;
+}
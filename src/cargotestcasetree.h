@@ -0,0 +1,107 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOTESTCASETREE_H
+#define CARGOTESTCASETREE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * The cases of a test suite, stored as a tree of their module paths.
+ *
+ * Case names like "tests::parser::numbers::negative" share their module prefixes, so every
+ * module is stored only once, and every distinct path segment is interned. Looking up a case
+ * walks the tree with one hash lookup per segment, without copying the name.
+ *
+ * Cases keep the order in which they were added.
+ */
+class CargoTestCaseTree
+{
+public:
+    CargoTestCaseTree();
+
+    /// Adds @p caseName if it is not in the tree yet
+    void addCase(const QString& caseName);
+
+    /// Adds @p caseName if it is not in the tree yet, and marks it as ignored
+    void addIgnoredCase(const QString& caseName);
+
+    bool contains(const QString& caseName) const;
+    bool isIgnored(const QString& caseName) const;
+
+    int size() const { return m_cases.size(); }
+    bool isEmpty() const { return m_cases.isEmpty(); }
+    int ignoredCount() const { return m_ignoredCount; }
+
+    /// @return the name of the @p index-th case
+    QString caseAt(int index) const;
+    bool isIgnoredAt(int index) const;
+
+    QStringList cases() const;
+    QStringList ignoredCases() const;
+
+    /// Frees memory reserved for adding more cases, once all cases are added
+    void squeeze();
+
+    /// @return whether both trees have the same cases, with the same ones ignored, in any order
+    bool operator==(const CargoTestCaseTree& other) const;
+    bool operator!=(const CargoTestCaseTree& other) const { return !(*this == other); }
+
+private:
+    enum NodeFlag
+    {
+        IsCase = 1,
+        IsIgnored = 2
+    };
+
+    struct Node
+    {
+        int parent;
+        int segment;
+        int flags;
+    };
+
+    /// @return the node of @p caseName, or -1 if it is not in the tree
+    int findNode(const QString& caseName) const;
+    /// @return the node of @p caseName, added if needed
+    int insertNode(const QString& caseName);
+    int addCaseNode(const QString& caseName);
+    QString nodeName(int node) const;
+
+    static quint64 childKey(int parent, int segment)
+    {
+        return (quint64(quint32(parent)) << 32) | quint32(segment);
+    }
+
+    QVector<QString> m_segments;
+    QHash<QString, int> m_segmentIds;
+    /// Node 0 is the root, which has no segment
+    QVector<Node> m_nodes;
+    QHash<quint64, int> m_children;
+    QVector<int> m_cases;
+    int m_ignoredCount;
+};
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargotesthistory.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#include <interfaces/iproject.h>
+
+#include "cargoplugin.h"
+#include "debug.h"
+
+using namespace KDevelop;
+
+namespace
+{
+
+/// Adds a time to a {"last", "total", "runs"} object
+QJsonObject addTime(QJsonObject times, qint64 time)
+{
+    times.insert(QStringLiteral("last"), time);
+    times.insert(QStringLiteral("total"), times.value(QStringLiteral("total")).toDouble() + time);
+    times.insert(QStringLiteral("runs"), times.value(QStringLiteral("runs")).toInt() + 1);
+    return times;
+}
+
+CargoTestHistory::Entry entry(const QString& suiteName, const QString& caseName, const QJsonObject& times)
+{
+    const int runs = times.value(QStringLiteral("runs")).toInt();
+    const qint64 total = times.value(QStringLiteral("total")).toDouble();
+    return {
+        suiteName,
+        caseName,
+        qint64(times.value(QStringLiteral("last")).toDouble()),
+        runs > 0 ? total / runs : 0,
+        runs,
+        times.value(QStringLiteral("failures")).toInt(),
+        times.value(QStringLiteral("failed")).toBool()
+    };
+}
+
+}
+
+CargoTestHistory::CargoTestHistory(const QString& fileName)
+ : m_fileName(fileName)
+{
+}
+
+QString CargoTestHistory::fileName(IProject* project)
+{
+    return CargoPlugin::dataDirectory(project) + QStringLiteral("/test-times.json");
+}
+
+void CargoTestHistory::addRun(const QString& suiteName, qint64 suiteTime, const QHash<QString, qint64>& caseTimes,
+                              const QSet<QString>& failedCases)
+{
+    if (suiteTime < 0 && caseTimes.isEmpty())
+    {
+        return;
+    }
+
+    QJsonObject history = load();
+    QJsonObject suite = history.value(suiteName).toObject();
+    if (suiteTime >= 0)
+    {
+        suite = addTime(suite, suiteTime);
+    }
+
+    QJsonObject cases = suite.value(QStringLiteral("cases")).toObject();
+    for (auto it = caseTimes.constBegin(); it != caseTimes.constEnd(); ++it)
+    {
+        QJsonObject times = addTime(cases.value(it.key()).toObject(), it.value());
+
+        const bool failed = failedCases.contains(it.key());
+        times.insert(QStringLiteral("failed"), failed);
+        if (failed)
+        {
+            times.insert(QStringLiteral("failures"), times.value(QStringLiteral("failures")).toInt() + 1);
+        }
+        cases.insert(it.key(), times);
+    }
+    suite.insert(QStringLiteral("cases"), cases);
+
+    history.insert(suiteName, suite);
+    store(history);
+}
+
+void CargoTestHistory::addPassedRun(const QString& suiteName, const QDateTime& started)
+{
+    QJsonObject history = load();
+    QJsonObject suite = history.value(suiteName).toObject();
+    suite.insert(QStringLiteral("passed"), started.toMSecsSinceEpoch());
+    history.insert(suiteName, suite);
+    store(history);
+}
+
+QDateTime CargoTestHistory::lastPassed(const QString& suiteName) const
+{
+    const QJsonValue passed = load().value(suiteName).toObject().value(QStringLiteral("passed"));
+    return passed.isDouble() ? QDateTime::fromMSecsSinceEpoch(qint64(passed.toDouble())) : QDateTime();
+}
+
+QVector<CargoTestHistory::Entry> CargoTestHistory::suites() const
+{
+    QVector<Entry> entries;
+    const QJsonObject history = load();
+    for (auto it = history.constBegin(); it != history.constEnd(); ++it)
+    {
+        const QJsonObject suite = it.value().toObject();
+        if (suite.contains(QStringLiteral("runs")))
+        {
+            entries << entry(it.key(), QString(), suite);
+        }
+    }
+    return entries;
+}
+
+QVector<CargoTestHistory::Entry> CargoTestHistory::cases() const
+{
+    QVector<Entry> entries;
+    const QJsonObject history = load();
+    for (auto it = history.constBegin(); it != history.constEnd(); ++it)
+    {
+        const QJsonObject cases = it.value().toObject().value(QStringLiteral("cases")).toObject();
+        for (auto caseIt = cases.constBegin(); caseIt != cases.constEnd(); ++caseIt)
+        {
+            entries << entry(it.key(), caseIt.key(), caseIt.value().toObject());
+        }
+    }
+    return entries;
+}
+
+CargoTestHistory::Entry CargoTestHistory::suite(const QString& suiteName) const
+{
+    return entry(suiteName, QString(), load().value(suiteName).toObject());
+}
+
+QHash<QString, CargoTestHistory::Entry> CargoTestHistory::suiteCases(const QString& suiteName) const
+{
+    QHash<QString, Entry> entries;
+    const QJsonObject cases = load().value(suiteName).toObject().value(QStringLiteral("cases")).toObject();
+    for (auto it = cases.constBegin(); it != cases.constEnd(); ++it)
+    {
+        entries.insert(it.key(), entry(suiteName, it.key(), it.value().toObject()));
+    }
+    return entries;
+}
+
+QJsonObject CargoTestHistory::load() const
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QJsonObject();
+    }
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+bool CargoTestHistory::store(const QJsonObject& history) const
+{
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(KDEV_CARGO) << "Could not write test history" << m_fileName << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(history).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOTESTHISTORY_H
+#define CARGOTESTHISTORY_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QJsonObject>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+namespace KDevelop
+{
+class IProject;
+}
+
+/**
+ * Run times of the test suites and test cases of a project, kept in the target directory across sessions.
+ *
+ * Only the latest and the average time of each suite and case are kept, so the history does not grow with runs.
+ */
+class CargoTestHistory
+{
+public:
+    /// Times of a suite, or of a case in a suite, in milliseconds
+    struct Entry
+    {
+        QString suiteName;
+        /// Empty for the times of a whole suite
+        QString caseName;
+        qint64 lastTime;
+        qint64 averageTime;
+        int runs;
+        /// Number of runs that failed, only known for cases
+        int failures;
+        bool lastFailed;
+    };
+
+    explicit CargoTestHistory(const QString& fileName);
+
+    /// @return the history file of @p project, in its target directory
+    static QString fileName(KDevelop::IProject* project);
+
+    /**
+     * Records a run of suite @p suiteName.
+     *
+     * @param suiteTime the wall time of the whole run, or -1 if only some cases were run
+     * @param caseTimes times of the cases that were run
+     * @param failedCases cases among @p caseTimes that failed
+     */
+    void addRun(const QString& suiteName, qint64 suiteTime, const QHash<QString, qint64>& caseTimes,
+                const QSet<QString>& failedCases = QSet<QString>());
+
+    /// Records that all cases of suite @p suiteName passed in a run started at @p started
+    void addPassedRun(const QString& suiteName, const QDateTime& started);
+
+    /// @return the start of the last run in which all cases of suite @p suiteName passed, invalid if there was none
+    QDateTime lastPassed(const QString& suiteName) const;
+
+    QVector<Entry> suites() const;
+    QVector<Entry> cases() const;
+
+    /// @return the times of suite @p suiteName, with no runs if it was never run as a whole
+    Entry suite(const QString& suiteName) const;
+
+    /// @return the times of the cases of suite @p suiteName, by case name
+    QHash<QString, Entry> suiteCases(const QString& suiteName) const;
+
+private:
+    QJsonObject load() const;
+    bool store(const QJsonObject& history) const;
+
+    QString m_fileName;
+};
+
+#endif
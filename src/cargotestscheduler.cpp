@@ -0,0 +1,268 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargotestscheduler.h"
+
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <vector>
+
+#include <util/processlinemaker.h>
+
+#include "debug.h"
+
+using namespace KDevelop;
+
+CargoTestProcess::CargoTestProcess(CargoTestScheduler* scheduler, const QString& executable, const QStringList& arguments, int wantedThreads)
+ : QObject(scheduler)
+ , m_scheduler(scheduler)
+ , m_executable(executable)
+ , m_arguments(arguments)
+ , m_wantedThreads(qMax(1, wantedThreads))
+ , m_threads(0)
+ , m_priority(0)
+ , m_sequence(0)
+ , m_startIndex(0)
+ , m_process(nullptr)
+ , m_lineMaker(nullptr)
+{
+}
+
+CargoTestProcess::~CargoTestProcess()
+{
+    kill();
+}
+
+void CargoTestProcess::start(int threads)
+{
+    m_threads = threads;
+    m_timer.start();
+
+    const QStringList arguments = m_arguments + QStringList{ QStringLiteral("--test-threads=%1").arg(threads) };
+
+    qCDebug(KDEV_CARGO) << "Starting test process" << m_executable << arguments;
+
+    m_process = new QProcess(this);
+    m_process->setProgram(m_executable);
+    m_process->setArguments(arguments);
+    m_lineMaker = new ProcessLineMaker(m_process, this);
+
+    connect(m_lineMaker, &ProcessLineMaker::receivedStdoutLines, this, &CargoTestProcess::receivedStandardOutput);
+    connect(m_lineMaker, &ProcessLineMaker::receivedStderrLines, this, &CargoTestProcess::receivedStandardError);
+    connect(m_process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, [this](int code, QProcess::ExitStatus status) {
+        // Crashes are reported through QProcess::error
+        if (status != QProcess::NormalExit)
+        {
+            return;
+        }
+        m_lineMaker->flushBuffers();
+        stop();
+        emit finished(code);
+    });
+    connect(m_process, static_cast<void(QProcess::*)(QProcess::ProcessError)>(&QProcess::error),
+            this, [this](QProcess::ProcessError error) {
+        m_lineMaker->flushBuffers();
+        stop();
+        emit failed(error);
+    });
+
+    m_process->start();
+    emit started();
+}
+
+qint64 CargoTestProcess::pid() const
+{
+    return m_process ? m_process->processId() : 0;
+}
+
+void CargoTestProcess::stop()
+{
+    if (m_scheduler)
+    {
+        m_scheduler->release(this);
+        m_scheduler = nullptr;
+    }
+}
+
+void CargoTestProcess::kill()
+{
+    if (!m_scheduler)
+    {
+        return;
+    }
+
+    stop();
+    if (m_process)
+    {
+        m_process->disconnect(this);
+        m_lineMaker->disconnect(this);
+        m_process->kill();
+    }
+}
+
+void CargoTestProcess::abort()
+{
+    if (m_scheduler)
+    {
+        kill();
+        emit failed(QProcess::Crashed);
+    }
+}
+
+CargoTestScheduler::CargoTestScheduler(QObject* parent)
+ : QObject(parent)
+ , m_usedThreads(0)
+ , m_sequence(0)
+ , m_startedInRun(0)
+ , m_lastRun{ 0, 0, 0, 0 }
+{
+    setMaxThreads(0);
+}
+
+CargoTestScheduler::~CargoTestScheduler()
+{
+    killAll();
+}
+
+void CargoTestScheduler::setMaxThreads(int threads)
+{
+    m_maxThreads = threads > 0 ? threads : qMax(1, QThread::idealThreadCount());
+    dispatch();
+}
+
+CargoTestProcess* CargoTestScheduler::schedule(const QString& executable, const QStringList& arguments, int wantedThreads)
+{
+    auto process = new CargoTestProcess(this, executable, arguments, wantedThreads);
+    process->m_sequence = m_sequence++;
+    m_waiting.enqueue(process);
+
+    // Processes are started from the event loop, so that callers can connect to them first
+    QTimer::singleShot(0, this, &CargoTestScheduler::dispatch);
+    return process;
+}
+
+void CargoTestScheduler::killAll()
+{
+    // Waiting processes go first, so that none of them is started when a running one is killed
+    const QList<CargoTestProcess*> processes = m_waiting + m_running;
+    for (auto process : processes)
+    {
+        process->abort();
+    }
+}
+
+qint64 CargoTestScheduler::makespan(const QVector<ProcessTime>& processes, int maxThreads)
+{
+    // The times at which each test thread is free again
+    std::vector<qint64> free(qMax(1, maxThreads), 0);
+    for (const auto& process : processes)
+    {
+        // A process starts once the last of the threads it uses is free, and holds all of them until it finishes
+        const int threads = qBound(1, process.threads, int(free.size()));
+        std::sort(free.begin(), free.end());
+        const qint64 finish = free[threads - 1] + process.duration;
+        std::fill(free.begin(), free.begin() + threads, finish);
+    }
+    return *std::max_element(free.begin(), free.end());
+}
+
+void CargoTestScheduler::dispatch()
+{
+    // Priorities are set after scheduling, so the queue is only sorted when processes are taken from it
+    std::stable_sort(m_waiting.begin(), m_waiting.end(), [](CargoTestProcess* a, CargoTestProcess* b) {
+        return a->m_priority > b->m_priority;
+    });
+
+    while (!m_waiting.isEmpty() && m_usedThreads < m_maxThreads)
+    {
+        CargoTestProcess* process = m_waiting.dequeue();
+
+        if (!m_runTimer.isValid())
+        {
+            m_runTimer.start();
+            m_startedInRun = 0;
+            m_finishedInRun.clear();
+        }
+        process->m_startIndex = m_startedInRun++;
+
+        // The free threads are shared among waiting processes, so that one large suite does not hold back the others
+        const int freeThreads = m_maxThreads - m_usedThreads;
+        const int threads = qBound(1, freeThreads / (m_waiting.size() + 1), process->m_wantedThreads);
+
+        m_usedThreads += threads;
+        m_running << process;
+        process->start(threads);
+    }
+}
+
+void CargoTestScheduler::release(CargoTestProcess* process)
+{
+    if (m_running.removeOne(process))
+    {
+        m_usedThreads -= process->m_threads;
+        m_finishedInRun << FinishedProcess{ process->m_sequence, process->m_startIndex,
+                                            { process->m_timer.elapsed(), process->m_threads } };
+        dispatch();
+    }
+    else
+    {
+        m_waiting.removeOne(process);
+    }
+
+    if (m_running.isEmpty() && m_waiting.isEmpty() && m_runTimer.isValid())
+    {
+        finishRun();
+    }
+}
+
+void CargoTestScheduler::finishRun()
+{
+    m_lastRun.processes = m_finishedInRun.size();
+    m_lastRun.makespan = m_runTimer.elapsed();
+    m_runTimer.invalidate();
+
+    // Both estimates use the measured durations and threads, so they only differ by the order
+    auto orderedMakespan = [this](int FinishedProcess::*order) {
+        QVector<FinishedProcess> processes = m_finishedInRun;
+        std::sort(processes.begin(), processes.end(), [order](const FinishedProcess& a, const FinishedProcess& b) {
+            return a.*order < b.*order;
+        });
+
+        QVector<ProcessTime> times;
+        for (const auto& process : processes)
+        {
+            times << process.time;
+        }
+        return makespan(times, m_maxThreads);
+    };
+    m_lastRun.queuedOrderMakespan = orderedMakespan(&FinishedProcess::sequence);
+    m_lastRun.startedOrderMakespan = orderedMakespan(&FinishedProcess::startIndex);
+
+    qCDebug(KDEV_CARGO) << "Test run of" << m_lastRun.processes << "processes took" << m_lastRun.makespan
+                        << "ms, estimated" << m_lastRun.queuedOrderMakespan << "ms in the queued order and"
+                        << m_lastRun.startedOrderMakespan << "ms in the started order";
+
+    emit runFinished(m_lastRun);
+}
@@ -0,0 +1,200 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOTESTSCHEDULER_H
+#define CARGOTESTSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QQueue>
+#include <QStringList>
+#include <QVector>
+
+class CargoTestScheduler;
+
+namespace KDevelop
+{
+class ProcessLineMaker;
+}
+
+/**
+ * A test executable run by the CargoTestScheduler.
+ *
+ * The process waits in the scheduler's queue until it is given test threads.
+ * Its owner deletes it once it is finished, or earlier to cancel it.
+ */
+class CargoTestProcess : public QObject
+{
+    Q_OBJECT
+public:
+    ~CargoTestProcess() override;
+
+    /// Kills the process if it is running, or removes it from the queue. No signals are emitted afterwards.
+    void kill();
+
+    /// @return the number of test threads the process was started with, 0 if it is still waiting
+    int threads() const { return m_threads; }
+
+    /// @return the native process id, 0 if the process is not running
+    qint64 pid() const;
+
+    /// Waiting processes with a higher priority are started first, processes with the same priority in the order they were queued
+    void setPriority(qint64 priority) { m_priority = priority; }
+    qint64 priority() const { return m_priority; }
+
+signals:
+    /// The scheduler gave the process its test threads and started it
+    void started();
+
+    void receivedStandardOutput(const QStringList& lines);
+    void receivedStandardError(const QStringList& lines);
+
+    /// The process exited normally with @p exitCode
+    void finished(int exitCode);
+
+    /// The process failed to start or crashed
+    void failed(QProcess::ProcessError error);
+
+private:
+    friend class CargoTestScheduler;
+
+    CargoTestProcess(CargoTestScheduler* scheduler, const QString& executable, const QStringList& arguments, int wantedThreads);
+
+    void start(int threads);
+    void stop();
+    void abort();
+
+    CargoTestScheduler* m_scheduler;
+    QString m_executable;
+    QStringList m_arguments;
+    int m_wantedThreads;
+    int m_threads;
+    qint64 m_priority;
+    int m_sequence;
+    int m_startIndex;
+    QElapsedTimer m_timer;
+    QProcess* m_process;
+    KDevelop::ProcessLineMaker* m_lineMaker;
+};
+
+/**
+ * Runs test executables of all projects on a shared pool of test threads, one per core by default.
+ *
+ * Test suites queue their processes once their jobs are started, so free cores take work from any
+ * suite whose job is running. The test view starts suite jobs one after another, so there only the
+ * processes of one suite share the threads. The plugin's actions that run several suites, such as
+ * running all test suites in parallel or only the affected ones, start all of their jobs at once.
+ * libtest runs the cases of a process in parallel as well, so every process is passed --test-threads
+ * with its share of the free threads, and the threads of all running processes never exceed the limit.
+ *
+ * A run lasts from starting a process while none was running until no process is running or waiting.
+ * Its makespan is reported together with estimates for running the same processes in the order they were
+ * queued and in the order they were started, so that the effect of process priorities can be measured.
+ * Both estimates keep the measured duration and the test threads of each process, so they only differ
+ * by the order. Priorities are set by the test jobs from the "Test Order" project setting, which is
+ * the only way to choose the order.
+ */
+class CargoTestScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    /// Wall times of a run in milliseconds
+    struct RunReport
+    {
+        int processes;
+        qint64 makespan;
+        /// Estimated for the order in which the processes were queued
+        qint64 queuedOrderMakespan;
+        /// Estimated for the order in which the processes were started
+        qint64 startedOrderMakespan;
+    };
+
+    /// A process that took @p duration milliseconds while using @p threads test threads
+    struct ProcessTime
+    {
+        qint64 duration;
+        int threads;
+    };
+
+    explicit CargoTestScheduler(QObject* parent = nullptr);
+    ~CargoTestScheduler() override;
+
+    /// Limits the test threads of all running processes together, 0 means one per available core
+    void setMaxThreads(int threads);
+    int maxThreads() const { return m_maxThreads; }
+
+    /// @return the number of test threads used by running processes
+    int usedThreads() const { return m_usedThreads; }
+
+    /**
+     * Queues running @p executable with @p arguments.
+     *
+     * @param wantedThreads the most test threads the process can use, usually the number of cases it runs
+     * @return the queued process, which is owned by the caller
+     */
+    CargoTestProcess* schedule(const QString& executable, const QStringList& arguments, int wantedThreads);
+
+    /// Kills all running and waiting processes, which report that they failed
+    void killAll();
+
+    /// @return the report of the last finished run, with no processes if there was none
+    RunReport lastRunReport() const { return m_lastRun; }
+
+    /**
+     * Estimates the makespan of @p processes started in this order, each as soon as
+     * as many of the @p maxThreads test threads as it uses are free.
+     */
+    static qint64 makespan(const QVector<ProcessTime>& processes, int maxThreads);
+
+signals:
+    void runFinished(const CargoTestScheduler::RunReport& report);
+
+private:
+    friend class CargoTestProcess;
+
+    /// A process of the current run that is done
+    struct FinishedProcess
+    {
+        int sequence;
+        int startIndex;
+        ProcessTime time;
+    };
+
+    void dispatch();
+    void release(CargoTestProcess* process);
+    void finishRun();
+
+    int m_maxThreads;
+    int m_usedThreads;
+    int m_sequence;
+    QQueue<CargoTestProcess*> m_waiting;
+    QList<CargoTestProcess*> m_running;
+
+    QElapsedTimer m_runTimer;
+    int m_startedInRun;
+    QVector<FinishedProcess> m_finishedInRun;
+    RunReport m_lastRun;
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cargotesttimesdialog.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTabWidget>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include <KLocalizedString>
+
+CargoTestTimesDialog::CargoTestTimesDialog(const CargoTestHistory& history, QWidget* parent)
+ : QDialog(parent)
+ , m_runLabel(new QLabel(this))
+{
+    setWindowTitle(i18n("Cargo Test Times"));
+
+    auto tabs = new QTabWidget(this);
+    tabs->addTab(createTree(history.cases(), true), i18n("Slowest Tests"));
+    tabs->addTab(createTree(history.suites(), false), i18n("Slowest Suites"));
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    m_runLabel->setWordWrap(true);
+    m_runLabel->hide();
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(m_runLabel);
+    layout->addWidget(tabs);
+    layout->addWidget(buttons);
+
+    resize(800, 500);
+}
+
+void CargoTestTimesDialog::setRunReport(const CargoTestScheduler::RunReport& report)
+{
+    if (report.processes == 0)
+    {
+        m_runLabel->hide();
+        return;
+    }
+
+    m_runLabel->setText(i18np("The last test run of %1 process took %2 s. Started in the order they were queued, "
+                              "its processes would take about %3 s, and about %4 s in the order they were started.",
+                              "The last test run of %1 processes took %2 s. Started in the order they were queued, "
+                              "its processes would take about %3 s, and about %4 s in the order they were started.",
+                              report.processes,
+                              report.makespan / 1000.0,
+                              report.queuedOrderMakespan / 1000.0,
+                              report.startedOrderMakespan / 1000.0));
+    m_runLabel->show();
+}
+
+QTreeWidget* CargoTestTimesDialog::createTree(const QVector<CargoTestHistory::Entry>& entries, bool withCases)
+{
+    auto tree = new QTreeWidget(this);
+    tree->setRootIsDecorated(false);
+    tree->setAlternatingRowColors(true);
+
+    QStringList headers = { i18n("Suite") };
+    if (withCases)
+    {
+        headers << i18n("Test");
+    }
+    headers << i18n("Average (s)") << i18n("Last (s)") << i18n("Runs");
+    if (withCases)
+    {
+        headers << i18n("Failures");
+    }
+    tree->setHeaderLabels(headers);
+
+    const int timeColumn = withCases ? 2 : 1;
+    for (const auto& entry : entries)
+    {
+        auto item = new QTreeWidgetItem(tree);
+        item->setText(0, entry.suiteName);
+        if (withCases)
+        {
+            item->setText(1, entry.caseName);
+        }
+
+        // Numbers are set as data, so that the columns sort numerically
+        item->setData(timeColumn, Qt::DisplayRole, entry.averageTime / 1000.0);
+        item->setData(timeColumn + 1, Qt::DisplayRole, entry.lastTime / 1000.0);
+        item->setData(timeColumn + 2, Qt::DisplayRole, entry.runs);
+        if (withCases)
+        {
+            item->setData(timeColumn + 3, Qt::DisplayRole, entry.failures);
+        }
+        for (int column = timeColumn; column < headers.size(); ++column)
+        {
+            item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+
+    tree->setSortingEnabled(true);
+    tree->sortByColumn(timeColumn, Qt::DescendingOrder);
+    tree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    return tree;
+}
@@ -0,0 +1,55 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARGOTESTTIMESDIALOG_H
+#define CARGOTESTTIMESDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+
+#include "cargotesthistory.h"
+#include "cargotestscheduler.h"
+
+class QLabel;
+class QTreeWidget;
+
+/**
+ * Shows the slowest test suites and test cases of a project from its CargoTestHistory.
+ *
+ * Both lists start sorted by average time, and can be sorted by any column.
+ */
+class CargoTestTimesDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    CargoTestTimesDialog(const CargoTestHistory& history, QWidget* parent = nullptr);
+
+    /// Also shows how long the last test run took, and how long it would take in the order the tests were queued
+    void setRunReport(const CargoTestScheduler::RunReport& report);
+
+private:
+    QTreeWidget* createTree(const QVector<CargoTestHistory::Entry>& entries, bool withCases);
+
+    QLabel* m_runLabel;
+};
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_cargofilterstrategy.h"
+#include "cargo-test-paths.h"
+#include "cargofilterstrategy.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTest>
+
+#include <atomic>
+#include <cstdlib>
+
+using namespace KDevelop;
+
+#ifdef __GLIBC__
+/*
+ * Count heap allocations by interposing malloc, which Qt's containers use directly.
+ * The counting is only enabled while the classifier is running.
+ */
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+
+static std::atomic<bool> s_countAllocations(false);
+static std::atomic<qint64> s_allocations(0);
+
+extern "C" void* malloc(size_t size)
+{
+    if (s_countAllocations.load(std::memory_order_relaxed))
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    if (s_countAllocations.load(std::memory_order_relaxed))
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* pointer, size_t size)
+{
+    if (s_countAllocations.load(std::memory_order_relaxed))
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_realloc(pointer, size);
+}
+#endif
+
+void CargoFilterStrategyBenchmark::initTestCase()
+{
+    QFile log(QStringLiteral(CARGO_TESTS_PROJECTS_DIR "/rustc-warnings.log"));
+    QVERIFY(log.open(QIODevice::ReadOnly | QIODevice::Text));
+
+    while (!log.atEnd())
+    {
+        QString line = QString::fromUtf8(log.readLine());
+        line.chop(1);
+        m_recordedLog << line;
+    }
+    QVERIFY(!m_recordedLog.isEmpty());
+}
+
+void CargoFilterStrategyBenchmark::benchErrorInLine_data()
+{
+    QTest::addColumn<int>("lineCount");
+
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+    QTest::newRow("1M") << 1000000;
+}
+
+void CargoFilterStrategyBenchmark::benchErrorInLine()
+{
+    QFETCH(int, lineCount);
+
+    // Replay the recorded log until we have enough lines, like a warning storm in a large workspace
+    QStringList lines;
+    lines.reserve(lineCount);
+    while (lines.size() < lineCount)
+    {
+        lines << m_recordedLog.mid(0, lineCount - lines.size());
+    }
+
+    const QUrl buildDir = QUrl::fromLocalFile(QStringLiteral("/tmp/kdev-cargo-bench"));
+    int errors = 0;
+    qint64 allocations = 0;
+    QElapsedTimer timer;
+
+    QBENCHMARK {
+        CargoFilterStrategy strategy(buildDir);
+        errors = 0;
+
+        timer.start();
+#ifdef __GLIBC__
+        s_allocations = 0;
+        s_countAllocations = true;
+#endif
+        for (const auto& line : lines)
+        {
+            if (strategy.errorInLine(line).type == FilteredItem::ErrorItem)
+            {
+                ++errors;
+            }
+        }
+#ifdef __GLIBC__
+        s_countAllocations = false;
+        allocations = s_allocations;
+#endif
+    }
+
+    const qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+    qDebug() << lineCount << "lines:" << qint64(lineCount) * 1000 / elapsed << "lines/s,"
+             << double(allocations) / lineCount << "allocations/line";
+
+    QVERIFY(errors > 0);
+}
+
+QTEST_GUILESS_MAIN(CargoFilterStrategyBenchmark);
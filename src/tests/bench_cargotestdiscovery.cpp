@@ -0,0 +1,117 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_cargotestdiscovery.h"
+#include "cargo-test-paths.h"
+#include "cargoelftestreader.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTest>
+
+using namespace KDevelop;
+
+namespace
+{
+
+Path projectPath()
+{
+    return Path(QStringLiteral(CARGO_TESTS_PROJECTS_DIR "/kdev-cargo-test"));
+}
+
+/// Lists the cases and the ignored cases of @p executable by running it twice, like CargoFindTestsJob does without reading
+int listCases(const QString& executable)
+{
+    int cases = 0;
+    for (const QStringList& arguments : { QStringList{ QStringLiteral("--list") },
+                                          QStringList{ QStringLiteral("--list"), QStringLiteral("--ignored") } })
+    {
+        QProcess process;
+        process.start(executable, arguments);
+        process.waitForFinished();
+        cases += process.readAllStandardOutput().count(": test\n");
+    }
+    return cases;
+}
+
+}
+
+void CargoTestDiscoveryBenchmark::initTestCase()
+{
+    const QString cargo = QStandardPaths::findExecutable(QStringLiteral("cargo"));
+    if (cargo.isEmpty())
+    {
+        QSKIP("Cargo is not installed");
+    }
+    QVERIFY(m_targetDir.isValid());
+
+    // The test executable is built into a temporary directory, to keep the project clean
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QStringLiteral("CARGO_TARGET_DIR"), m_targetDir.path());
+
+    QProcess process;
+    process.setProcessEnvironment(environment);
+    process.setWorkingDirectory(projectPath().toLocalFile());
+    process.start(cargo, { QStringLiteral("test"), QStringLiteral("--no-run"), QStringLiteral("--message-format=json") });
+    QVERIFY(process.waitForFinished(-1));
+    QCOMPARE(process.exitCode(), 0);
+
+    for (const QByteArray& line : process.readAllStandardOutput().split('\n'))
+    {
+        const QJsonObject message = QJsonDocument::fromJson(line).object();
+        if (message.value(QStringLiteral("reason")).toString() == QLatin1String("compiler-artifact")
+            && message.value(QStringLiteral("profile")).toObject().value(QStringLiteral("test")).toBool())
+        {
+            m_executable = message.value(QStringLiteral("executable")).toString();
+        }
+    }
+    QVERIFY(!m_executable.isEmpty());
+}
+
+void CargoTestDiscoveryBenchmark::benchReadExecutable()
+{
+    CargoElfTestReader reader(m_executable);
+    if (!reader.read(projectPath()))
+    {
+        QSKIP("Test executables of this toolchain cannot be read");
+    }
+
+    int cases = 0;
+    QBENCHMARK {
+        reader.read(projectPath());
+        cases = reader.cases().size() + reader.ignoredCases().size();
+    }
+    QCOMPARE(cases, listCases(m_executable));
+}
+
+void CargoTestDiscoveryBenchmark::benchListExecutable()
+{
+    int cases = 0;
+    QBENCHMARK {
+        cases = listCases(m_executable);
+    }
+    QVERIFY(cases > 0);
+}
+
+QTEST_GUILESS_MAIN(CargoTestDiscoveryBenchmark);
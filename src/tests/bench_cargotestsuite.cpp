@@ -0,0 +1,124 @@
+/*
+ * This file is part of the Cargo plugin for KDevelop.
+ *
+ * Copyright 2017 Miha Čančula <miha@noughmad.eu>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_cargotestsuite.h"
+#include "cargotestcasetree.h"
+
+#include <QTest>
+
+namespace
+{
+
+/// Like a large workspace, 100 modules with 10 groups of 100 cases each
+enum { ModuleCount = 100, GroupCount = 10, GroupSize = 100 };
+
+/// Every tenth case is ignored
+enum { IgnoredInterval = 10 };
+
+CargoTestCaseTree buildTree(const QStringList& cases, const QStringList& ignoredCases)
+{
+    CargoTestCaseTree tree;
+    for (const auto& caseName : cases)
+    {
+        tree.addCase(caseName);
+    }
+    for (const auto& caseName : ignoredCases)
+    {
+        tree.addIgnoredCase(caseName);
+    }
+    tree.squeeze();
+    return tree;
+}
+
+}
+
+void CargoTestSuiteBenchmark::initTestCase()
+{
+    for (int module = 0; module < ModuleCount; ++module)
+    {
+        for (int group = 0; group < GroupCount; ++group)
+        {
+            for (int i = 0; i < GroupSize; ++i)
+            {
+                const QString caseName = QStringLiteral("tests::module_%1::group_%2::case_%3").arg(module).arg(group).arg(i);
+                m_cases << caseName;
+                if (i % IgnoredInterval == 0)
+                {
+                    m_ignoredCases << caseName;
+                }
+            }
+        }
+    }
+}
+
+void CargoTestSuiteBenchmark::benchRegisterCases()
+{
+    // Like CargoFindTestsJob does once a suite is listed
+    int size = 0;
+    QBENCHMARK {
+        size = buildTree(m_cases, m_ignoredCases).size();
+    }
+    QCOMPARE(size, m_cases.size());
+}
+
+void CargoTestSuiteBenchmark::benchSelectCases()
+{
+    // Running all cases selected in the test view splits off the ignored ones, which run with --ignored
+    const CargoTestCaseTree tree = buildTree(m_cases, m_ignoredCases);
+    int ignored = 0;
+    QBENCHMARK {
+        ignored = 0;
+        for (const auto& caseName : m_cases)
+        {
+            if (tree.isIgnored(caseName))
+            {
+                ++ignored;
+            }
+        }
+    }
+    QCOMPARE(ignored, m_ignoredCases.size());
+}
+
+void CargoTestSuiteBenchmark::benchListCases()
+{
+    // Running the whole suite, and showing it in the test view, needs the names of all cases
+    const CargoTestCaseTree tree = buildTree(m_cases, m_ignoredCases);
+    QStringList cases;
+    QBENCHMARK {
+        cases = tree.cases();
+    }
+    QCOMPARE(cases, m_cases);
+}
+
+void CargoTestSuiteBenchmark::benchCompareCases()
+{
+    // Finding tests again only replaces suites whose cases changed
+    const CargoTestCaseTree tree = buildTree(m_cases, m_ignoredCases);
+    const CargoTestCaseTree found = buildTree(m_cases, m_ignoredCases);
+    bool same = false;
+    QBENCHMARK {
+        same = tree == found;
+    }
+    QVERIFY(same);
+}
+
+QTEST_GUILESS_MAIN(CargoTestSuiteBenchmark);
@@ -0,0 +1,11 @@
+pub fn line(i: u32) -> String {
+    format!("line {}", i)
+}
+
+#[cfg(test)]
+mod tests {
+    #[test]
+    fn in_lib() {
+        assert_eq!(super::line(1), "line 1");
+    }
+}
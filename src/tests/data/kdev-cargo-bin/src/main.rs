@@ -0,0 +1,15 @@
+extern crate kdev_cargo_bin;
+
+fn main() {
+    for i in 0..1000 {
+        println!("{}", kdev_cargo_bin::line(i));
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    #[test]
+    fn in_bin() {
+        assert_eq!(kdev_cargo_bin::line(2), "line 2");
+    }
+}
@@ -22,13 +22,37 @@
 
 #include "test_cargo.h"
 #include "cargo-test-paths.h"
+#include "cargobenchmarkresults.h"
 #include "cargobuildjob.h"
+#include "cargocache.h"
+#include "cargodepinfoindex.h"
+#include "cargoelftestreader.h"
+#include "cargofindbenchmarksjob.h"
 #include "cargofindtestsjob.h"
+#include "cargomanifest.h"
+#include "cargometadata.h"
+#include "cargofilterstrategy.h"
+#include "cargomessageparser.h"
+#include "cargooutputmodel.h"
+#include "cargoproblemreporter.h"
+#include "cargostackdump.h"
+#include "cargotestcasetree.h"
 #include "cargoplugin.h"
+#include "cargotesthistory.h"
+#include "cargotestscheduler.h"
 #include "debug.h"
 
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTemporaryDir>
 #include <QTest>
 #include <QSignalSpy>
+#include <KConfigGroup>
 #include <KJob>
 
 #include <tests/testcore.h>
@@ -74,6 +98,45 @@ IProject* loadProject(const QString& name)
     return project;
 }
 
+/**
+ * Writes a fake test executable to @p dir, which lists @p cases and logs every run to "runs",
+ * while counting the runs that overlap with it in "running".
+ */
+QString writeListingScript(const QString& dir, const QString& fileName, const QStringList& cases)
+{
+    QString script = QStringLiteral("#!/bin/sh\n"
+                                    "echo \"$0\" >> %1/runs\n"
+                                    "mkdir -p %1/running && touch %1/running/$$\n"
+                                    "ls %1/running | wc -l >> %1/overlaps\n"
+                                    "sleep 0.2\n"
+                                    "rm %1/running/$$\n"
+                                    "[ \"$2\" = \"--ignored\" ] && exit 0\n").arg(dir);
+    for (const auto& caseName : cases)
+    {
+        script += QStringLiteral("echo \"%1: test\"\n").arg(caseName);
+    }
+
+    const QString fileNamePath = dir + QLatin1Char('/') + fileName;
+    QFile file(fileNamePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return QString();
+    }
+    file.write(script.toUtf8());
+    file.setPermissions(file.permissions() | QFileDevice::ExeOwner);
+    return fileNamePath;
+}
+
+QStringList readLines(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QStringList();
+    }
+    return QString::fromUtf8(file.readAll()).split(QLatin1Char('\n'), QString::SkipEmptyParts);
+}
+
 void CargoPluginTest::initTestCase()
 {
     QLoggingCategory::setFilterRules(QStringLiteral("kdevelop.projectmanagers.cargo.debug = true"));
@@ -90,11 +153,15 @@ void CargoPluginTest::initTestCase()
 
     qDebug() << Core::self()->pluginController()->loadedPlugins();
 
+    // Jobs started directly by the tests share this instance, so that only one problem model is registered
+    m_plugin = new CargoPlugin(Core::self());
+
     cleanup();
 }
 
 void CargoPluginTest::cleanupTestCase()
 {
+    delete m_plugin;
     TestCore::shutdown();
 }
 
@@ -120,12 +187,25 @@ void CargoPluginTest::testBuildProject()
     QVERIFY(built);
 }
 
+void CargoPluginTest::testSkipBuildOutput()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
+    QVERIFY(project);
+
+    auto plugin = dynamic_cast<CargoPlugin*>(project->buildSystemManager());
+    QVERIFY(plugin);
+
+    QVERIFY(plugin->isValid(Path(project->path(), QStringLiteral("src")), true, project));
+    QVERIFY(!plugin->isValid(Path(project->path(), QStringLiteral("target")), true, project));
+    QVERIFY(!plugin->isValid(Path(project->path(), QStringLiteral(".cargo/registry")), true, project));
+}
+
 void CargoPluginTest::testFindTests()
 {
     IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
     QVERIFY(project);
 
-    CargoPlugin* plugin = new CargoPlugin(Core::self());
+    CargoPlugin* plugin = m_plugin;
 
     CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
     job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
@@ -133,6 +213,7 @@ void CargoPluginTest::testFindTests()
     QVERIFY(static_cast<KJob*>(job)->exec());
 
     CargoFindTestsJob* findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+    findTestsJob->setReadExecutables(true);
     QVERIFY(findTestsJob->exec());
 
     QList<ITestSuite*> suites = Core::self()->testController()->testSuitesForProject(project);
@@ -153,15 +234,209 @@ void CargoPluginTest::testFindTests()
             QStringLiteral("tests::is_ignored_and_fails"),
         };
         QCOMPARE(suite->cases().toSet(), expectedCases);
+
+        // Finding the same tests again, this time by listing them, keeps the registered suite
+        findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+        findTestsJob->setReadExecutables(false);
+        QVERIFY(findTestsJob->exec());
+
+        suites = Core::self()->testController()->testSuitesForProject(project);
+        QCOMPARE(suites.size(), 1);
+        QCOMPARE(suites.first(), suite);
+    }
+}
+
+void CargoPluginTest::testFindSameNamedTargets()
+{
+    QMap<QString, QString> qualifiedNames = {
+        { QStringLiteral("/ws/target/debug/deps/tool-1"), QStringLiteral("tool::tool (lib)") },
+        { QStringLiteral("/ws/target/debug/deps/tool-2"), QStringLiteral("tool::tool (bin)") },
+        { QStringLiteral("/ws/target/debug/deps/other-3"), QStringLiteral("other::other (lib)") },
+        { QStringLiteral("/ws/target/debug/deps/it-4"), QStringLiteral("it") },
+        { QStringLiteral("/ws/target/debug/deps/it-5"), QStringLiteral("it") },
+    };
+    const QMap<QString, QString> suiteNames = CargoFindTestsJob::uniqueSuiteNames(qualifiedNames);
+    QCOMPARE(suiteNames.value(QStringLiteral("/ws/target/debug/deps/tool-1")), QStringLiteral("tool::tool (lib)"));
+    QCOMPARE(suiteNames.value(QStringLiteral("/ws/target/debug/deps/tool-2")), QStringLiteral("tool::tool (bin)"));
+    QCOMPARE(suiteNames.value(QStringLiteral("/ws/target/debug/deps/other-3")), QStringLiteral("other"));
+    QCOMPARE(suiteNames.value(QStringLiteral("/ws/target/debug/deps/it-4")), QStringLiteral("it (it-4)"));
+    QCOMPARE(suiteNames.value(QStringLiteral("/ws/target/debug/deps/it-5")), QStringLiteral("it (it-5)"));
+
+    // The library and the binary of this package are both built as test executables named after the crate
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-bin"));
+    QVERIFY(project);
+
+    auto plugin = dynamic_cast<CargoPlugin*>(project->buildSystemManager());
+    QVERIFY(plugin);
+
+    CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
+    job->setJsonDiagnostics(true);
+    job->setRunArguments({ QStringLiteral("--no-run") });
+    job->setStandardViewType(KDevelop::IOutputView::BuildView);
+    job->setAutoDelete(false);
+    QVERIFY(static_cast<KJob*>(job)->exec());
+
+    QMap<QString, QString> executables;
+    for (const auto& artifact : job->artifacts())
+    {
+        if (artifact.test && artifact.executable.isValid())
+        {
+            executables.insert(artifact.executable.toLocalFile(), CargoFindTestsJob::qualifiedSuiteName(artifact));
+        }
+    }
+    delete job;
+    QCOMPARE(executables.size(), 2);
+
+    CargoFindTestsJob* findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+    findTestsJob->setTestExecutables(executables);
+    QVERIFY(findTestsJob->exec());
+
+    // Each suite runs its own executable, so its cases are not mixed with those of the other one
+    ITestController* testController = Core::self()->testController();
+    QCOMPARE(testController->testSuitesForProject(project).size(), 2);
+    ITestSuite* lib = testController->findTestSuite(project, QStringLiteral("kdev-cargo-bin::kdev_cargo_bin (lib)"));
+    ITestSuite* bin = testController->findTestSuite(project, QStringLiteral("kdev-cargo-bin::kdev_cargo_bin (bin)"));
+    QVERIFY(lib);
+    QVERIFY(bin);
+    QCOMPARE(lib->cases(), QStringList({ QStringLiteral("tests::in_lib") }));
+    QCOMPARE(bin->cases(), QStringList({ QStringLiteral("tests::in_bin") }));
+
+    QSignalSpy spy(testController, &ITestController::testRunFinished);
+    QVERIFY(spy.isValid());
+    QVERIFY(bin->launchAllCases(ITestSuite::Silent)->exec());
+    QCOMPARE(spy.count(), 1);
+    const TestResult result = qvariant_cast<TestResult>(spy.at(0).at(1));
+    QCOMPARE(result.testCaseResults.value(QStringLiteral("tests::in_bin")), TestResult::Passed);
+
+    // The remembered executables keep their names when the tests are found without a build
+    findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+    QVERIFY(findTestsJob->exec());
+    QCOMPARE(testController->testSuitesForProject(project).size(), 2);
+    QCOMPARE(testController->findTestSuite(project, QStringLiteral("kdev-cargo-bin::kdev_cargo_bin (lib)")), lib);
+}
+
+void CargoPluginTest::testDiscoveryProcesses()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-bin"));
+    QVERIFY(project);
+
+    auto plugin = dynamic_cast<CargoPlugin*>(project->buildSystemManager());
+    QVERIFY(plugin);
+
+    QTemporaryDir dir;
+    QMap<QString, QString> executables;
+    for (int i = 0; i < 6; ++i)
+    {
+        const QString suiteName = QStringLiteral("pool_%1").arg(i);
+        const QString executable = writeListingScript(dir.path(), QStringLiteral("%1-%2").arg(suiteName).arg(i), { QStringLiteral("case") });
+        QVERIFY(!executable.isEmpty());
+        executables.insert(executable, suiteName);
+    }
+
+    auto findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+    findTestsJob->setTestExecutables(executables);
+    findTestsJob->setReadExecutables(false);
+    findTestsJob->setMaxProcesses(2);
+    findTestsJob->setAutoDelete(false);
+    QVERIFY(findTestsJob->exec());
+
+    // Every executable is listed twice, once for its cases and once for its ignored cases
+    QCOMPARE(readLines(dir.path() + QStringLiteral("/runs")).size(), 12);
+    int maxOverlap = 0;
+    for (const auto& overlap : readLines(dir.path() + QStringLiteral("/overlaps")))
+    {
+        maxOverlap = qMax(maxOverlap, overlap.trimmed().toInt());
+    }
+    QVERIFY(maxOverlap >= 1);
+    QVERIFY(maxOverlap <= 2);
+
+    // Progress is counted in executables
+    QCOMPARE(findTestsJob->totalAmount(KJob::Files), 6ull);
+    QCOMPARE(findTestsJob->processedAmount(KJob::Files), 6ull);
+    delete findTestsJob;
+
+    for (int i = 0; i < 6; ++i)
+    {
+        ITestSuite* suite = Core::self()->testController()->findTestSuite(project, QStringLiteral("pool_%1").arg(i));
+        QVERIFY(suite);
+        QCOMPARE(suite->cases(), QStringList({ QStringLiteral("case") }));
     }
 }
 
+void CargoPluginTest::testListingCache()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-bin"));
+    QVERIFY(project);
+
+    auto plugin = dynamic_cast<CargoPlugin*>(project->buildSystemManager());
+    QVERIFY(plugin);
+
+    QTemporaryDir dir;
+    const QString first = writeListingScript(dir.path(), QStringLiteral("cached_first-1"), { QStringLiteral("one") });
+    const QString second = writeListingScript(dir.path(), QStringLiteral("cached_second-2"), { QStringLiteral("two") });
+    QVERIFY(!first.isEmpty());
+    QVERIFY(!second.isEmpty());
+    const QMap<QString, QString> executables = {
+        { first, QStringLiteral("cached_first") },
+        { second, QStringLiteral("cached_second") },
+    };
+    const QString runs = dir.path() + QStringLiteral("/runs");
+
+    auto findTests = [&]() {
+        auto findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+        findTestsJob->setTestExecutables(executables);
+        findTestsJob->setReadExecutables(false);
+        return findTestsJob->exec();
+    };
+    auto cases = [project](const QString& suiteName) {
+        ITestSuite* suite = Core::self()->testController()->findTestSuite(project, suiteName);
+        return suite ? suite->cases() : QStringList();
+    };
+
+    QVERIFY(findTests());
+    QCOMPARE(readLines(runs).size(), 4);
+    QCOMPARE(cases(QStringLiteral("cached_first")), QStringList({ QStringLiteral("one") }));
+
+    // Unchanged executables are not run again
+    QVERIFY(findTests());
+    QCOMPARE(readLines(runs).size(), 4);
+    QCOMPARE(cases(QStringLiteral("cached_first")), QStringList({ QStringLiteral("one") }));
+    QCOMPARE(cases(QStringLiteral("cached_second")), QStringList({ QStringLiteral("two") }));
+
+    // A different size makes the first executable listed again, the second one still comes from the cache
+    QTest::qWait(10);
+    QVERIFY(!writeListingScript(dir.path(), QStringLiteral("cached_first-1"), { QStringLiteral("one"), QStringLiteral("three") }).isEmpty());
+    QVERIFY(findTests());
+    QStringList lines = readLines(runs);
+    QCOMPARE(lines.size(), 6);
+    QCOMPARE(lines.mid(4), QStringList({ first, first }));
+    QCOMPARE(cases(QStringLiteral("cached_first")).toSet(), QSet<QString>({ QStringLiteral("one"), QStringLiteral("three") }));
+
+    // So does a new modification time with different contents of the same size
+    QTest::qWait(10);
+    QVERIFY(!writeListingScript(dir.path(), QStringLiteral("cached_second-2"), { QStringLiteral("owt") }).isEmpty());
+    QVERIFY(findTests());
+    lines = readLines(runs);
+    QCOMPARE(lines.size(), 8);
+    QCOMPARE(lines.mid(6), QStringList({ second, second }));
+    QCOMPARE(cases(QStringLiteral("cached_second")), QStringList({ QStringLiteral("owt") }));
+
+    // Executables are not hashed, so only touching one lists it again
+    const qint64 later = QDateTime::currentDateTime().addSecs(60).toMSecsSinceEpoch() / 1000;
+    QCOMPARE(QProcess::execute(QStringLiteral("touch"), { QStringLiteral("-m"), QStringLiteral("-d"), QStringLiteral("@%1").arg(later), second }), 0);
+    QVERIFY(QFileInfo(second).lastModified().toMSecsSinceEpoch() / 1000 == later);
+    QVERIFY(findTests());
+    QCOMPARE(readLines(runs).size(), 10);
+    QVERIFY(findTests());
+    QCOMPARE(readLines(runs).size(), 10);
+}
+
 void CargoPluginTest::testRunTests()
 {
     IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
     QVERIFY(project);
 
-    CargoPlugin* plugin = new CargoPlugin(Core::self());
+    CargoPlugin* plugin = m_plugin;
 
     CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
     job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
@@ -207,12 +482,135 @@ void CargoPluginTest::testRunTests()
     }
 }
 
+void CargoPluginTest::testRunReportsOnce()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-bin"));
+    QVERIFY(project);
+
+    auto plugin = dynamic_cast<CargoPlugin*>(project->buildSystemManager());
+    QVERIFY(plugin);
+
+    // A fake test executable whose second case finishes long after the first one
+    QTemporaryDir dir;
+    const QString executable = dir.path() + QStringLiteral("/slow_suite-1");
+    QFile file(executable);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("#!/bin/sh\n"
+               "case \"$*\" in\n"
+               "*--ignored*|*--help*) exit 0 ;;\n"
+               "*--list*) echo \"first: test\"; echo \"second: test\"; exit 0 ;;\n"
+               "esac\n"
+               "echo \"running 2 tests\"\n"
+               "echo \"test first ... ok\"\n"
+               "sleep 1.5\n"
+               "echo \"test second ... FAILED\"\n"
+               "exit 101\n");
+    file.close();
+    QVERIFY(file.setPermissions(file.permissions() | QFileDevice::ExeOwner));
+
+    auto findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+    findTestsJob->setTestExecutables({ { executable, QStringLiteral("slow_suite") } });
+    findTestsJob->setReadExecutables(false);
+    QVERIFY(findTestsJob->exec());
+
+    ITestController* testController = Core::self()->testController();
+    ITestSuite* suite = testController->findTestSuite(project, QStringLiteral("slow_suite"));
+    QVERIFY(suite);
+    QCOMPARE(suite->cases().size(), 2);
+
+    // The first case finishes long before the run, but the test view still gets a single result
+    QSignalSpy spy(testController, &ITestController::testRunFinished);
+    QVERIFY(spy.isValid());
+    suite->launchAllCases(ITestSuite::Silent)->exec();
+    QTest::qWait(200);
+    QCOMPARE(spy.count(), 1);
+
+    const TestResult result = qvariant_cast<TestResult>(spy.at(0).at(1));
+    QCOMPARE(result.suiteResult, TestResult::Failed);
+    QCOMPARE(result.testCaseResults.size(), 2);
+    QCOMPARE(result.testCaseResults.value(QStringLiteral("first")), TestResult::Passed);
+    QCOMPARE(result.testCaseResults.value(QStringLiteral("second")), TestResult::Failed);
+}
+
+void CargoPluginTest::testRunTimeouts()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-bin"));
+    QVERIFY(project);
+
+    auto plugin = dynamic_cast<CargoPlugin*>(project->buildSystemManager());
+    QVERIFY(plugin);
+
+    // A fake test executable that hangs when running several cases at once, or a case that has a file named after it
+    QTemporaryDir dir;
+    const QString executable = dir.path() + QStringLiteral("/hang_suite-1");
+    QFile file(executable);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QStringLiteral("#!/bin/sh\n"
+                              "case \"$*\" in\n"
+                              "*--help*) echo \"Usage: hang_suite [OPTIONS] [FILTERS...]\"; exit 0 ;;\n"
+                              "*--ignored*) exit 0 ;;\n"
+                              "*--list*) echo \"first: test\"; echo \"second: test\"; exit 0 ;;\n"
+                              "esac\n"
+                              "echo \"running tests\"\n"
+                              "case \"$*\" in\n"
+                              "*--test-threads=1*) ;;\n"
+                              "*) sleep 30 ;;\n"
+                              "esac\n"
+                              "for c in \"$@\"; do\n"
+                              "  case \"$c\" in first|second) [ -e %1/hang_$c ] && sleep 30; echo \"test $c ... ok\" ;; esac\n"
+                              "done\n").arg(dir.path()).toUtf8());
+    file.close();
+    QVERIFY(file.setPermissions(file.permissions() | QFileDevice::ExeOwner));
+
+    auto findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+    findTestsJob->setTestExecutables({ { executable, QStringLiteral("hang_suite") } });
+    findTestsJob->setReadExecutables(false);
+    QVERIFY(findTestsJob->exec());
+
+    ITestController* testController = Core::self()->testController();
+    ITestSuite* suite = testController->findTestSuite(project, QStringLiteral("hang_suite"));
+    QVERIFY(suite);
+
+    KConfigGroup config(project->projectConfiguration(), "Cargo");
+    QSignalSpy spy(testController, &ITestController::testRunFinished);
+    QVERIFY(spy.isValid());
+
+    // A process running both cases on two threads hangs, but each case passes on its own, which is the result
+    plugin->testScheduler()->setMaxThreads(2);
+    config.writeEntry("Test Case Timeout", 1);
+    suite->launchAllCases(ITestSuite::Silent)->exec();
+    QCOMPARE(spy.count(), 1);
+    TestResult result = qvariant_cast<TestResult>(spy.takeFirst().at(1));
+    QCOMPARE(result.suiteResult, TestResult::Passed);
+    QCOMPARE(result.testCaseResults.value(QStringLiteral("first")), TestResult::Passed);
+    QCOMPARE(result.testCaseResults.value(QStringLiteral("second")), TestResult::Passed);
+
+    // When the suite times out, the case of the shard that never started is an error as well
+    plugin->testScheduler()->setMaxThreads(1);
+    config.deleteEntry("Test Case Timeout");
+    config.writeEntry("Test Suite Timeout", 1);
+    config.writeEntry("Test Shards", QStringLiteral("hang_suite=2"));
+    QFile hangFile(dir.path() + QStringLiteral("/hang_first"));
+    QVERIFY(hangFile.open(QIODevice::WriteOnly));
+    hangFile.close();
+    suite->launchAllCases(ITestSuite::Silent)->exec();
+    QCOMPARE(spy.count(), 1);
+    result = qvariant_cast<TestResult>(spy.takeFirst().at(1));
+    QCOMPARE(result.suiteResult, TestResult::Failed);
+    QCOMPARE(result.testCaseResults.value(QStringLiteral("first")), TestResult::Error);
+    QCOMPARE(result.testCaseResults.value(QStringLiteral("second")), TestResult::Error);
+
+    config.deleteEntry("Test Suite Timeout");
+    config.deleteEntry("Test Shards");
+    plugin->testScheduler()->setMaxThreads(0);
+}
+
 void CargoPluginTest::testRunSingleCases()
 {
     IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
     QVERIFY(project);
 
-    CargoPlugin* plugin = new CargoPlugin(Core::self());
+    CargoPlugin* plugin = m_plugin;
 
     CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
     job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
@@ -262,7 +660,7 @@ void CargoPluginTest::testRunIgnoredCases()
     IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
     QVERIFY(project);
 
-    CargoPlugin* plugin = new CargoPlugin(Core::self());
+    CargoPlugin* plugin = m_plugin;
 
     CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
     job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
@@ -308,6 +706,909 @@ void CargoPluginTest::testRunIgnoredCases()
     }
 }
 
+void CargoPluginTest::testRunSelectedCases()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
+    QVERIFY(project);
+
+    CargoPlugin* plugin = m_plugin;
+
+    CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
+    job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
+    job->setStandardViewType(KDevelop::IOutputView::BuildView);
+    QVERIFY(static_cast<KJob*>(job)->exec());
+
+    CargoFindTestsJob* findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+    QVERIFY(findTestsJob->exec());
+
+    QList<ITestSuite*> suites = Core::self()->testController()->testSuitesForProject(project);
+    QCOMPARE(suites.size(), 1);
+
+    if (suites.size() == 1)
+    {
+        ITestSuite* suite = suites.first();
+
+        QSignalSpy spy(Core::self()->testController(), &ITestController::testRunFinished);
+        QVERIFY(spy.isValid());
+
+        // Selected cases are run together, and selected ignored cases are run as well
+        suite->launchCases({ QStringLiteral("tests::passes"), QStringLiteral("tests::fails"), QStringLiteral("tests::is_ignored_and_passes") },
+                           ITestSuite::Silent)->exec();
+
+        QCOMPARE(spy.count(), 1);
+
+        TestResult result = qvariant_cast<TestResult>(spy.at(0).at(1));
+        QCOMPARE(result.suiteResult, TestResult::Failed);
+        QCOMPARE(result.testCaseResults.size(), 3);
+        QCOMPARE(result.testCaseResults.value(QStringLiteral("tests::passes")), TestResult::Passed);
+        QCOMPARE(result.testCaseResults.value(QStringLiteral("tests::fails")), TestResult::Failed);
+        QCOMPARE(result.testCaseResults.value(QStringLiteral("tests::is_ignored_and_passes")), TestResult::Passed);
+    }
+}
+
+void CargoPluginTest::testTestScheduler()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
+    QVERIFY(project);
+
+    CargoPlugin* plugin = m_plugin;
+
+    CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
+    job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
+    job->setStandardViewType(KDevelop::IOutputView::BuildView);
+    QVERIFY(static_cast<KJob*>(job)->exec());
+
+    QString executable;
+    for (const auto& artifact : job->artifacts())
+    {
+        if (artifact.test && artifact.executable.isValid())
+        {
+            executable = artifact.executable.toLocalFile();
+        }
+    }
+    QVERIFY(!executable.isEmpty());
+
+    CargoTestScheduler scheduler;
+    scheduler.setMaxThreads(2);
+
+    QList<CargoTestProcess*> processes;
+    int finished = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        CargoTestProcess* process = scheduler.schedule(executable, { QStringLiteral("--list") }, 4);
+        connect(process, &CargoTestProcess::finished, this, [&finished, &scheduler]() {
+            QVERIFY(scheduler.usedThreads() <= scheduler.maxThreads());
+            ++finished;
+        });
+        processes << process;
+    }
+
+    QTRY_COMPARE(finished, 3);
+    QCOMPARE(scheduler.usedThreads(), 0);
+
+    // The free threads are shared among waiting processes, and the third one waits for one of them
+    for (auto process : processes)
+    {
+        QCOMPARE(process->threads(), 1);
+    }
+    qDeleteAll(processes);
+}
+
+void CargoPluginTest::testRunSuitesInParallel()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-bin"));
+    QVERIFY(project);
+
+    auto plugin = dynamic_cast<CargoPlugin*>(project->buildSystemManager());
+    QVERIFY(plugin);
+
+    // Fake test executables that count how many of their test runs overlap
+    QTemporaryDir dir;
+    QVERIFY(QDir(dir.path()).mkdir(QStringLiteral("running")));
+    QMap<QString, QString> executables;
+    for (const auto& suiteName : { QStringLiteral("parallel_a"), QStringLiteral("parallel_b") })
+    {
+        const QString executable = dir.path() + QLatin1Char('/') + suiteName + QStringLiteral("-1");
+        QFile file(executable);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QStringLiteral("#!/bin/sh\n"
+                                  "case \"$*\" in\n"
+                                  "*--help*|*--ignored*) exit 0 ;;\n"
+                                  "*--list*) echo \"case: test\"; exit 0 ;;\n"
+                                  "esac\n"
+                                  "touch %1/running/$$\n"
+                                  "ls %1/running | wc -l >> %1/overlaps\n"
+                                  "sleep 0.5\n"
+                                  "rm %1/running/$$\n"
+                                  "echo \"test case ... ok\"\n").arg(dir.path()).toUtf8());
+        file.close();
+        QVERIFY(file.setPermissions(file.permissions() | QFileDevice::ExeOwner));
+        executables.insert(executable, suiteName);
+    }
+
+    // Both suites are run once they are found, and their processes share the scheduler's threads
+    plugin->testScheduler()->setMaxThreads(2);
+    QSignalSpy spy(Core::self()->testController(), &ITestController::testRunFinished);
+    QVERIFY(spy.isValid());
+    auto findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+    findTestsJob->setTestExecutables(executables);
+    findTestsJob->setReadExecutables(false);
+    findTestsJob->setRunAfterFinding(CargoFindTestsJob::RunAllSuites);
+    QVERIFY(findTestsJob->exec());
+
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 2, 10000);
+    for (const auto& arguments : spy)
+    {
+        QCOMPARE(qvariant_cast<TestResult>(arguments.at(1)).suiteResult, TestResult::Passed);
+    }
+    int maxOverlap = 0;
+    for (const auto& overlap : readLines(dir.path() + QStringLiteral("/overlaps")))
+    {
+        maxOverlap = qMax(maxOverlap, overlap.trimmed().toInt());
+    }
+    QCOMPARE(maxOverlap, 2);
+    plugin->testScheduler()->setMaxThreads(0);
+}
+
+void CargoPluginTest::testRunShardedSuite()
+{
+    QCOMPARE(CargoFindTestsJob::shardCount(QString(), QStringLiteral("a")), 1);
+    QCOMPARE(CargoFindTestsJob::shardCount(QStringLiteral("a=4, b = 2"), QStringLiteral("b")), 2);
+    QCOMPARE(CargoFindTestsJob::shardCount(QStringLiteral("a=4,b=2"), QStringLiteral("c")), 1);
+    QCOMPARE(CargoFindTestsJob::shardCount(QStringLiteral("a=x"), QStringLiteral("a")), 1);
+
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
+    QVERIFY(project);
+
+    CargoPlugin* plugin = m_plugin;
+
+    CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
+    job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
+    job->setStandardViewType(KDevelop::IOutputView::BuildView);
+    QVERIFY(static_cast<KJob*>(job)->exec());
+
+    CargoFindTestsJob* findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+    QVERIFY(findTestsJob->exec());
+
+    QList<ITestSuite*> suites = Core::self()->testController()->testSuitesForProject(project);
+    QCOMPARE(suites.size(), 1);
+
+    if (suites.size() == 1)
+    {
+        KConfigGroup config(project->projectConfiguration(), "Cargo");
+        config.writeEntry("Test Shards", QStringLiteral("kdev_cargo_test=4"));
+
+        QSignalSpy spy(Core::self()->testController(), &ITestController::testRunFinished);
+        QVERIFY(spy.isValid());
+
+        suites.first()->launchAllCases(ITestSuite::Silent)->exec();
+        config.deleteEntry("Test Shards");
+
+        // The shards report a single result, the same as running the whole suite in one process
+        QCOMPARE(spy.count(), 1);
+
+        TestResult result = qvariant_cast<TestResult>(spy.at(0).at(1));
+        QCOMPARE(result.suiteResult, TestResult::Failed);
+        QCOMPARE(result.testCaseResults.size(), 6);
+        QCOMPARE(result.testCaseResults.value(QStringLiteral("tests::passes")), TestResult::Passed);
+        QCOMPARE(result.testCaseResults.value(QStringLiteral("tests::fails")), TestResult::Failed);
+        QCOMPARE(result.testCaseResults.value(QStringLiteral("tests::is_ignored_and_passes")), TestResult::NotRun);
+    }
+}
+
+void CargoPluginTest::testTestHistory()
+{
+    QTemporaryDir dir;
+    CargoTestHistory history(dir.path() + QStringLiteral("/target/kdevelop/test-times.json"));
+    QVERIFY(history.cases().isEmpty());
+
+    history.addRun(QStringLiteral("a"), 300, { { QStringLiteral("slow"), 200 }, { QStringLiteral("fast"), 10 } });
+    history.addRun(QStringLiteral("a"), 500, { { QStringLiteral("slow"), 400 } });
+
+    // Running only some cases does not count as a run of the suite
+    history.addRun(QStringLiteral("b"), -1, { { QStringLiteral("only"), 50 } });
+
+    const QVector<CargoTestHistory::Entry> suites = history.suites();
+    QCOMPARE(suites.size(), 1);
+    QCOMPARE(suites[0].suiteName, QStringLiteral("a"));
+    QCOMPARE(suites[0].lastTime, qint64(500));
+    QCOMPARE(suites[0].averageTime, qint64(400));
+    QCOMPARE(suites[0].runs, 2);
+
+    QHash<QString, CargoTestHistory::Entry> cases;
+    for (const auto& entry : history.cases())
+    {
+        cases.insert(entry.suiteName + QLatin1Char('/') + entry.caseName, entry);
+    }
+    QCOMPARE(cases.size(), 3);
+    QCOMPARE(cases[QStringLiteral("a/slow")].averageTime, qint64(300));
+    QCOMPARE(cases[QStringLiteral("a/slow")].runs, 2);
+    QCOMPARE(cases[QStringLiteral("a/fast")].lastTime, qint64(10));
+    QCOMPARE(cases[QStringLiteral("b/only")].runs, 1);
+}
+
+void CargoPluginTest::testTestOrder()
+{
+    QCOMPARE(CargoFindTestsJob::testOrder(QString()), CargoFindTestsJob::DefaultOrder);
+    QCOMPARE(CargoFindTestsJob::testOrder(QStringLiteral("FailedFirst")), CargoFindTestsJob::FailedFirstOrder);
+    QCOMPARE(CargoFindTestsJob::testOrder(QStringLiteral("LongestFirst")), CargoFindTestsJob::LongestFirstOrder);
+
+    // Longest first packs the shards evenly, while round-robin puts both long cases in the same shard
+    const QStringList cases = { QStringLiteral("d"), QStringLiteral("c"), QStringLiteral("b"), QStringLiteral("a") };
+    QCOMPARE(CargoFindTestsJob::assignShards(cases, {}, 2),
+             QVector<QStringList>({ { QStringLiteral("a"), QStringLiteral("c") }, { QStringLiteral("b"), QStringLiteral("d") } }));
+    const QHash<QString, qint64> times = { { QStringLiteral("a"), 10 }, { QStringLiteral("c"), 9 }, { QStringLiteral("b"), 2 } };
+    QCOMPARE(CargoFindTestsJob::assignShards(cases, times, 2),
+             QVector<QStringList>({ { QStringLiteral("a"), QStringLiteral("b") }, { QStringLiteral("c"), QStringLiteral("d") } }));
+
+    QCOMPARE(CargoTestScheduler::makespan({ { 5, 1 }, { 5, 1 }, { 10, 1 } }, 2), qint64(15));
+    QCOMPARE(CargoTestScheduler::makespan({ { 10, 1 }, { 5, 1 }, { 5, 1 } }, 2), qint64(10));
+    // A process using both threads waits for all of them and holds back the processes after it
+    QCOMPARE(CargoTestScheduler::makespan({ { 5, 1 }, { 10, 2 }, { 5, 1 } }, 2), qint64(20));
+    QCOMPARE(CargoTestScheduler::makespan({ { 10, 2 }, { 5, 1 }, { 5, 1 } }, 2), qint64(15));
+
+    QTemporaryDir dir;
+    CargoTestHistory history(dir.path() + QStringLiteral("/test-times.json"));
+    history.addRun(QStringLiteral("a"), 100, { { QStringLiteral("flaky"), 10 }, { QStringLiteral("failing"), 10 } },
+                   { QStringLiteral("flaky") });
+    history.addRun(QStringLiteral("a"), 100, { { QStringLiteral("flaky"), 10 }, { QStringLiteral("failing"), 10 } },
+                   { QStringLiteral("failing") });
+    const QHash<QString, CargoTestHistory::Entry> entries = history.suiteCases(QStringLiteral("a"));
+    QCOMPARE(entries[QStringLiteral("flaky")].failures, 1);
+    QVERIFY(!entries[QStringLiteral("flaky")].lastFailed);
+    QVERIFY(entries[QStringLiteral("failing")].lastFailed);
+
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
+    QVERIFY(project);
+
+    CargoPlugin* plugin = m_plugin;
+
+    CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
+    job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
+    job->setStandardViewType(KDevelop::IOutputView::BuildView);
+    QVERIFY(static_cast<KJob*>(job)->exec());
+
+    QString executable;
+    for (const auto& artifact : job->artifacts())
+    {
+        if (artifact.test && artifact.executable.isValid())
+        {
+            executable = artifact.executable.toLocalFile();
+        }
+    }
+    QVERIFY(!executable.isEmpty());
+
+    // With a single thread, processes run one at a time, highest priority first
+    CargoTestScheduler scheduler;
+    scheduler.setMaxThreads(1);
+
+    QList<CargoTestProcess*> processes;
+    QList<qint64> finished;
+    for (qint64 priority : { 0, 2, 1 })
+    {
+        CargoTestProcess* process = scheduler.schedule(executable, { QStringLiteral("--list") }, 1);
+        process->setPriority(priority);
+        connect(process, &CargoTestProcess::finished, this, [&finished, process]() {
+            finished << process->priority();
+        });
+        processes << process;
+    }
+
+    QTRY_COMPARE(finished.size(), 3);
+    QCOMPARE(finished, QList<qint64>({ 2, 1, 0 }));
+    QCOMPARE(scheduler.lastRunReport().processes, 3);
+    QVERIFY(scheduler.lastRunReport().makespan >= scheduler.lastRunReport().startedOrderMakespan);
+    qDeleteAll(processes);
+}
+
+void CargoPluginTest::testDepInfoIndex()
+{
+    const QByteArray depInfo =
+        "/ws/target/debug/deps/a-1.d: src/lib.rs src/with\\ space.rs /registry/dep/src/lib.rs\n"
+        "\n"
+        "/ws/target/debug/deps/a-1: src/lib.rs src/with\\ space.rs /registry/dep/src/lib.rs\n"
+        "\n"
+        "src/lib.rs:\n"
+        "src/with\\ space.rs:\n"
+        "# env-dep:CARGO_PKG_NAME=a\n";
+    QCOMPARE(CargoDepInfoIndex::parseDepInfo(depInfo, QStringLiteral("/ws")),
+             QStringList({ QStringLiteral("/ws/src/lib.rs"), QStringLiteral("/ws/src/with space.rs"), QStringLiteral("/registry/dep/src/lib.rs") }));
+    QCOMPARE(CargoDepInfoIndex::depInfoFileName(QStringLiteral("/ws/target/debug/deps/a-1.exe")), QStringLiteral("/ws/target/debug/deps/a-1.d"));
+
+    QTemporaryDir dir;
+    auto writeFile = [&dir](const QString& name, const QByteArray& contents) {
+        QFile file(dir.filePath(name));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(contents);
+    };
+    writeFile(QStringLiteral("common.rs"), QByteArray());
+    writeFile(QStringLiteral("a.rs"), QByteArray());
+    writeFile(QStringLiteral("a-1"), QByteArray());
+    writeFile(QStringLiteral("a-1.d"), "a-1: common.rs a.rs\n");
+    writeFile(QStringLiteral("b-1"), QByteArray());
+    writeFile(QStringLiteral("b-1.d"), "b-1: common.rs\n");
+
+    const QString a = dir.filePath(QStringLiteral("a-1"));
+    const QString b = dir.filePath(QStringLiteral("b-1"));
+    CargoDepInfoIndex index(dir.path());
+    index.update({ a, b });
+
+    QCOMPARE(index.sources(a).size(), 2);
+    QStringList executables = index.executables(dir.filePath(QStringLiteral("common.rs")));
+    executables.sort();
+    QCOMPARE(executables, QStringList({ a, b }));
+    QCOMPARE(index.executables(dir.filePath(QStringLiteral("a.rs"))), QStringList({ a }));
+
+    // Suites that never passed are affected, as are suites whose sources changed after they passed
+    const QDateTime modified = QFileInfo(dir.filePath(QStringLiteral("a.rs"))).lastModified();
+    QCOMPARE(index.affectedExecutables({ { a, modified.addSecs(10) }, { b, QDateTime() } }), QSet<QString>({ b }));
+    QCOMPARE(index.affectedExecutables({ { a, modified.addSecs(-10) }, { b, modified.addSecs(10) } }), QSet<QString>({ a }));
+
+    // Executables that no longer exist are forgotten
+    QVERIFY(QFile::remove(b));
+    index.update({ a });
+    QCOMPARE(index.executables(dir.filePath(QStringLiteral("common.rs"))), QStringList({ a }));
+
+    QTemporaryDir historyDir;
+    CargoTestHistory history(historyDir.path() + QStringLiteral("/test-times.json"));
+    QVERIFY(!history.lastPassed(QStringLiteral("a")).isValid());
+    history.addPassedRun(QStringLiteral("a"), modified);
+    QCOMPARE(history.lastPassed(QStringLiteral("a")), QDateTime::fromMSecsSinceEpoch(modified.toMSecsSinceEpoch()));
+}
+
+void CargoPluginTest::testTestCaseTree()
+{
+    CargoTestCaseTree tree;
+    tree.addCase(QStringLiteral("tests::a::first"));
+    tree.addCase(QStringLiteral("tests::a::second"));
+    tree.addIgnoredCase(QStringLiteral("tests::b::first"));
+    tree.addCase(QStringLiteral("top"));
+    tree.addCase(QStringLiteral("tests::a::first"));
+    // Ignored cases listed separately are not added twice
+    tree.addIgnoredCase(QStringLiteral("tests::a::second"));
+
+    QCOMPARE(tree.size(), 4);
+    QCOMPARE(tree.ignoredCount(), 2);
+    QCOMPARE(tree.cases(), QStringList({ QStringLiteral("tests::a::first"), QStringLiteral("tests::a::second"),
+                                         QStringLiteral("tests::b::first"), QStringLiteral("top") }));
+    QCOMPARE(tree.ignoredCases(), QStringList({ QStringLiteral("tests::a::second"), QStringLiteral("tests::b::first") }));
+
+    // Modules are not cases themselves
+    QVERIFY(tree.contains(QStringLiteral("tests::b::first")));
+    QVERIFY(!tree.contains(QStringLiteral("tests::b")));
+    QVERIFY(!tree.contains(QStringLiteral("tests::b::first::more")));
+    QVERIFY(!tree.contains(QStringLiteral("tests::c")));
+    QVERIFY(tree.isIgnored(QStringLiteral("tests::b::first")));
+    QVERIFY(!tree.isIgnored(QStringLiteral("tests::a::first")));
+    QVERIFY(!tree.isIgnored(QStringLiteral("missing")));
+
+    CargoTestCaseTree reordered;
+    reordered.addCase(QStringLiteral("top"));
+    reordered.addIgnoredCase(QStringLiteral("tests::b::first"));
+    reordered.addIgnoredCase(QStringLiteral("tests::a::second"));
+    reordered.addCase(QStringLiteral("tests::a::first"));
+    reordered.squeeze();
+    QVERIFY(tree == reordered);
+
+    reordered.addIgnoredCase(QStringLiteral("tests::a::first"));
+    QVERIFY(tree != reordered);
+}
+
+void CargoPluginTest::testBenchmarkResults()
+{
+    bool criterion = true;
+    QCOMPARE(CargoFindBenchmarksJob::parseBenchmarkList({ QStringLiteral("tests::works: test"), QStringLiteral("parse: bench"),
+                                                          QStringLiteral(""), QStringLiteral("2 tests, 1 benchmarks") }, &criterion),
+             QStringList({ QStringLiteral("parse") }));
+    QVERIFY(!criterion);
+    QCOMPARE(CargoFindBenchmarksJob::parseBenchmarkList({ QStringLiteral("fib/20: benchmark") }, &criterion),
+             QStringList({ QStringLiteral("fib/20") }));
+    QVERIFY(criterion);
+    QCOMPARE(CargoFindBenchmarksJob::suiteNameForTarget(QStringLiteral("my-bench")), QStringLiteral("my_bench (bench)"));
+
+    CargoBenchmarkResults::Estimate estimate = {};
+    QVERIFY(CargoBenchmarkResults::parseLibtestLine(QStringLiteral("test parse ... bench:       1,234 ns/iter (+/- 56)"), &estimate));
+    QCOMPARE(estimate.benchmarkName, QStringLiteral("parse"));
+    QCOMPARE(estimate.time, 1234.0);
+    QCOMPARE(estimate.lowerBound, 1178.0);
+    QCOMPARE(estimate.upperBound, 1290.0);
+    QCOMPARE(estimate.confidenceLevel, 0.0);
+    QVERIFY(CargoBenchmarkResults::parseLibtestLine(QStringLiteral("test io::read ... bench:      12.50 ns/iter (+/- 20.25) = 80 MB/s"), &estimate));
+    QCOMPARE(estimate.benchmarkName, QStringLiteral("io::read"));
+    QCOMPARE(estimate.lowerBound, 0.0);
+    QVERIFY(!CargoBenchmarkResults::parseLibtestLine(QStringLiteral("test parse ... ok"), &estimate));
+    QCOMPARE(CargoBenchmarkResults::formatTime(1234.0), QStringLiteral("1.234 µs"));
+
+    QTemporaryDir dir;
+    auto writeFile = [&dir](const QString& name, const QByteArray& contents) {
+        QVERIFY(QDir(dir.path()).mkpath(QFileInfo(dir.filePath(name)).path()));
+        QFile file(dir.filePath(name));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(contents);
+    };
+    const QByteArray estimates =
+        "{\"mean\":{\"confidence_interval\":{\"confidence_level\":0.95,\"lower_bound\":90.0,\"upper_bound\":110.0},\"point_estimate\":100.0},"
+        "\"slope\":null}";
+    const QByteArray linearEstimates =
+        "{\"mean\":{\"confidence_interval\":{\"confidence_level\":0.95,\"lower_bound\":1.0,\"upper_bound\":3.0},\"point_estimate\":2.0},"
+        "\"slope\":{\"confidence_interval\":{\"confidence_level\":0.99,\"lower_bound\":4.0,\"upper_bound\":6.0},\"point_estimate\":5.0}}";
+    writeFile(QStringLiteral("criterion/fib/20/new/benchmark.json"), "{\"full_id\":\"fib/20\"}");
+    writeFile(QStringLiteral("criterion/fib/20/new/estimates.json"), estimates);
+    writeFile(QStringLiteral("criterion/fib/20/base/benchmark.json"), "{\"full_id\":\"fib/20\"}");
+    writeFile(QStringLiteral("criterion/fib/20/base/estimates.json"), estimates);
+    writeFile(QStringLiteral("criterion/sort/new/benchmark.json"), "{\"full_id\":\"sort\"}");
+    writeFile(QStringLiteral("criterion/sort/new/estimates.json"), linearEstimates);
+
+    // Only the latest measurement of each benchmark counts, and the slope is preferred when there is one
+    QHash<QString, CargoBenchmarkResults::Estimate> criterionEstimates;
+    for (const auto& estimate : CargoBenchmarkResults::readCriterionEstimates(dir.filePath(QStringLiteral("criterion")), QDateTime()))
+    {
+        criterionEstimates.insert(estimate.benchmarkName, estimate);
+    }
+    QCOMPARE(criterionEstimates.size(), 2);
+    QCOMPARE(criterionEstimates[QStringLiteral("fib/20")].time, 100.0);
+    QCOMPARE(criterionEstimates[QStringLiteral("fib/20")].lowerBound, 90.0);
+    QCOMPARE(criterionEstimates[QStringLiteral("fib/20")].confidenceLevel, 0.95);
+    QCOMPARE(criterionEstimates[QStringLiteral("sort")].time, 5.0);
+    QCOMPARE(criterionEstimates[QStringLiteral("sort")].upperBound, 6.0);
+    QVERIFY(CargoBenchmarkResults::readCriterionEstimates(dir.filePath(QStringLiteral("criterion")),
+                                                          QDateTime::currentDateTime().addSecs(60)).isEmpty());
+
+    CargoBenchmarkResults results(dir.path() + QStringLiteral("/target/kdevelop/benchmarks.json"));
+    QVERIFY(results.estimates().isEmpty());
+    CargoBenchmarkResults::Estimate fib = criterionEstimates[QStringLiteral("fib/20")];
+    fib.suiteName = QStringLiteral("fib (bench)");
+    results.addEstimates({ fib });
+    QCOMPARE(results.estimates().size(), 1);
+    QCOMPARE(results.estimates()[0].previousTime, -1.0);
+
+    fib.time = 120.0;
+    results.addEstimates({ fib });
+    QCOMPARE(results.estimates().size(), 1);
+    QCOMPARE(results.estimates()[0].time, 120.0);
+    QCOMPARE(results.estimates()[0].previousTime, 100.0);
+    QCOMPARE(results.estimates()[0].suiteName, QStringLiteral("fib (bench)"));
+}
+
+void CargoPluginTest::testRepeatCases()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
+    QVERIFY(project);
+
+    CargoPlugin* plugin = m_plugin;
+
+    CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
+    job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
+    job->setStandardViewType(KDevelop::IOutputView::BuildView);
+    QVERIFY(static_cast<KJob*>(job)->exec());
+
+    CargoFindTestsJob* findTestsJob = new CargoFindTestsJob(plugin, project->projectItem());
+    QVERIFY(findTestsJob->exec());
+
+    QList<ITestSuite*> suites = Core::self()->testController()->testSuitesForProject(project);
+    QCOMPARE(suites.size(), 1);
+    ITestSuite* suite = suites.first();
+
+    // The last result of each case is kept, so failed cases can be run again
+    suite->launchCases({ QStringLiteral("tests::passes"), QStringLiteral("tests::fails") }, ITestSuite::Silent)->exec();
+    QCOMPARE(CargoFindTestsJob::failedCases(suite), QStringList({ QStringLiteral("tests::fails") }));
+
+    QSignalSpy spy(Core::self()->testController(), &ITestController::testRunFinished);
+    QVERIFY(spy.isValid());
+
+    // A repeated case fails if any of its repetitions failed
+    KJob* repeatJob = CargoFindTestsJob::launchRepeatedCases(suite, { QStringLiteral("tests::passes"), QStringLiteral("tests::fails") }, 3, false);
+    QVERIFY(repeatJob);
+    QVERIFY(!repeatJob->exec());
+
+    QVERIFY(spy.count() >= 1);
+    TestResult result = qvariant_cast<TestResult>(spy.last().at(1));
+    QCOMPARE(result.suiteResult, TestResult::Failed);
+    QCOMPARE(result.testCaseResults.value(QStringLiteral("tests::passes")), TestResult::Passed);
+    QCOMPARE(result.testCaseResults.value(QStringLiteral("tests::fails")), TestResult::Failed);
+
+    // Stopping at the first failure still reports it
+    repeatJob = CargoFindTestsJob::launchRepeatedCases(suite, { QStringLiteral("tests::fails") }, 20, true);
+    QVERIFY(!repeatJob->exec());
+    result = qvariant_cast<TestResult>(spy.last().at(1));
+    QCOMPARE(result.testCaseResults.value(QStringLiteral("tests::fails")), TestResult::Failed);
+    QCOMPARE(CargoFindTestsJob::failedCases(suite), QStringList({ QStringLiteral("tests::fails") }));
+}
+
+void CargoPluginTest::testStackDump()
+{
+#ifdef Q_OS_LINUX
+    QVERIFY(CargoStackDump::procStacks(QCoreApplication::applicationPid()).startsWith(QLatin1String("Thread ")));
+
+    QProcess hanging;
+    hanging.start(QStringLiteral("sleep"), { QStringLiteral("60") });
+    QVERIFY(hanging.waitForStarted());
+
+    // Either gdb or /proc shows the stacks, depending on what the system allows
+    auto dump = new CargoStackDump(hanging.processId());
+    QSignalSpy spy(dump, &CargoStackDump::finished);
+    dump->start();
+    QVERIFY(spy.wait(CargoStackDump::GdbTimeout + 5000));
+    QVERIFY(!spy.at(0).at(0).toString().isEmpty());
+
+    hanging.kill();
+    hanging.waitForFinished();
+#else
+    QSKIP("Stacks are only dumped on Linux");
+#endif
+}
+
+void CargoPluginTest::testParseJsonMessages()
+{
+    CargoMessageParser parser(Path(QStringLiteral("/tmp/project")));
+
+    const QByteArray message = "{\"reason\":\"compiler-message\",\"message\":{\"level\":\"warning\","
+        "\"message\":\"unused variable: `x`\",\"spans\":[{\"file_name\":\"src/lib.rs\",\"is_primary\":true,"
+        "\"line_start\":3,\"column_start\":9}],"
+        "\"rendered\":\"warning: unused variable: `x`\\n --> src/lib.rs:3:9\\n\"}}\n";
+
+    // Messages may be split at any point between two reads from the process
+    const int split = message.size() / 2;
+    QVERIFY(parser.feed(message.left(split)).isEmpty());
+    QVector<FilteredItem> items = parser.feed(message.mid(split) + "plain output");
+
+    QCOMPARE(items.size(), 2);
+    QCOMPARE(items[0].type, FilteredItem::WarningItem);
+    QCOMPARE(items[0].originalLine, QStringLiteral("warning: unused variable: `x`"));
+    QCOMPARE(items[0].url, QUrl::fromLocalFile(QStringLiteral("/tmp/project/src/lib.rs")));
+    QCOMPARE(items[0].lineNo, 2);
+    QCOMPARE(items[0].columnNo, 8);
+    QCOMPARE(items[1].type, FilteredItem::InformationItem);
+    QCOMPARE(items[1].lineNo, 2);
+
+    const QVector<CargoDiagnostic> diagnostics = parser.takeDiagnostics();
+    QCOMPARE(diagnostics.size(), 1);
+    QCOMPARE(diagnostics[0].message, QStringLiteral("unused variable: `x`"));
+    QCOMPARE(diagnostics[0].file, Path(QStringLiteral("/tmp/project/src/lib.rs")));
+    QVERIFY(parser.takeDiagnostics().isEmpty());
+
+    // Up to date artifacts are not shown, but still reported
+    items = parser.parseLine("{\"reason\":\"compiler-artifact\",\"package_id\":\"path+file:///tmp/project#kdev-cargo-test@0.1.0\","
+                             "\"target\":{\"kind\":[\"lib\"],\"name\":\"kdev-cargo-test\"},\"profile\":{\"test\":true},\"executable\":\"/tmp/project/target/debug/deps/kdev_cargo_test-0123\","
+                             "\"fresh\":true}");
+    QVERIFY(items.isEmpty());
+    const QVector<CargoArtifact> artifacts = parser.takeArtifacts();
+    QCOMPARE(artifacts.size(), 1);
+    QVERIFY(artifacts[0].test);
+    QCOMPARE(artifacts[0].executable, Path(QStringLiteral("/tmp/project/target/debug/deps/kdev_cargo_test-0123")));
+    QCOMPARE(CargoFindTestsJob::suiteNameForTarget(artifacts[0].targetName), QStringLiteral("kdev_cargo_test"));
+    QCOMPARE(artifacts[0].packageName, QStringLiteral("kdev-cargo-test"));
+    QCOMPARE(CargoFindTestsJob::qualifiedSuiteName(artifacts[0]), QStringLiteral("kdev-cargo-test::kdev_cargo_test (lib)"));
+
+    // Lines that are not JSON messages are left unclassified
+    items = parser.flush();
+    QCOMPARE(items.size(), 1);
+    QCOMPARE(items[0].type, FilteredItem::InvalidItem);
+    QCOMPARE(items[0].originalLine, QStringLiteral("plain output"));
+}
+
+void CargoPluginTest::testBoundedOutput()
+{
+    CargoOutputModel model(QUrl::fromLocalFile(QStringLiteral("/tmp/project")), 3,
+                           QStringLiteral("/tmp/project/target/kdevelop/build.log"));
+
+    FilteredItem error(QStringLiteral("error: oops"), FilteredItem::ErrorItem);
+    error.isActivatable = true;
+    error.url = QUrl::fromLocalFile(QStringLiteral("/tmp/project/src/lib.rs"));
+
+    QVector<FilteredItem> items;
+    items << FilteredItem(QStringLiteral("first"), FilteredItem::StandardItem) << error;
+    for (int i = 0; i < 10; ++i)
+    {
+        items << FilteredItem(QStringLiteral("line %1").arg(i), FilteredItem::StandardItem);
+    }
+    model.appendItems(items);
+
+    // The marker row, the retained error, and the three most recent lines
+    QCOMPARE(model.rowCount(), 5);
+    QVERIFY(model.index(0).data().toString().contains(QLatin1String("8")));
+    QCOMPARE(model.index(1).data().toString(), QStringLiteral("error: oops"));
+    QCOMPARE(model.index(4).data().toString(), QStringLiteral("line 9"));
+    QCOMPARE(model.firstHighlightIndex(), model.index(1));
+
+    // Old errors and warnings are retained only up to a limit, the oldest are dropped first
+    items.clear();
+    for (int i = 0; i < CargoOutputModel::MaxRetainedItems + 3; ++i)
+    {
+        items << FilteredItem(QStringLiteral("warning: %1").arg(i), FilteredItem::WarningItem);
+    }
+    model.appendItems(items);
+
+    QCOMPARE(model.rowCount(), 1 + CargoOutputModel::MaxRetainedItems + 3);
+    QCOMPARE(model.index(1).data().toString(), QStringLiteral("warning: 0"));
+    QVERIFY(model.index(0).data().toString().contains(QLatin1String("12")));
+}
+
+void CargoPluginTest::testBuildJobOutput()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-bin"));
+    QVERIFY(project);
+
+    auto plugin = dynamic_cast<CargoPlugin*>(project->buildSystemManager());
+    QVERIFY(plugin);
+
+    // The binary prints a thousand numbered lines, which pass through the pipeline's thread in batches
+    auto job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("run"));
+    job->setRunArguments({ QStringLiteral("--quiet") });
+    job->setAutoDelete(false);
+    QSignalSpy resultSpy(job, &KJob::result);
+    QVERIFY(job->exec());
+
+    QAbstractItemModel* model = job->model();
+    QVERIFY(model);
+    auto lastLine = [model]() {
+        return model->rowCount() > 0 ? model->index(model->rowCount() - 1, 0).data().toString() : QString();
+    };
+    QTRY_VERIFY(lastLine().contains(QLatin1String("***")));
+
+    QStringList lines;
+    for (int row = 0; row < model->rowCount(); ++row)
+    {
+        const QString line = model->index(row, 0).data().toString();
+        if (line.startsWith(QLatin1String("line ")))
+        {
+            lines << line;
+        }
+    }
+    QCOMPARE(lines.size(), 1000);
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        QCOMPARE(lines[i], QStringLiteral("line %1").arg(i));
+    }
+
+    // Neither the end of the process nor its output reports the result again
+    QTest::qWait(200);
+    QCOMPARE(resultSpy.count(), 1);
+    delete job;
+}
+
+void CargoPluginTest::testClassifiedItems()
+{
+    CargoClassifiedItems classifiedItems;
+    classifiedItems.enqueue({ FilteredItem(QStringLiteral("warning: dropped"), FilteredItem::WarningItem),
+                              FilteredItem(QStringLiteral("error: first"), FilteredItem::ErrorItem),
+                              FilteredItem(QStringLiteral("error: second"), FilteredItem::ErrorItem) });
+
+    FilteredItem item(QString());
+    QVERIFY(!classifiedItems.takeMatching(QStringLiteral("plain output"), &item));
+    QCOMPARE(classifiedItems.size(), 3);
+
+    // A line that never reached the model does not keep later lines from matching
+    QVERIFY(classifiedItems.takeMatching(QStringLiteral("error: first"), &item));
+    QCOMPARE(item.type, FilteredItem::ErrorItem);
+    QCOMPARE(classifiedItems.size(), 1);
+
+    // Trailing whitespace, such as a carriage return, is not compared
+    QVERIFY(classifiedItems.takeMatching(QStringLiteral("error: second\r"), &item));
+    QCOMPARE(item.originalLine, QStringLiteral("error: second"));
+    QCOMPARE(classifiedItems.size(), 0);
+}
+
+void CargoPluginTest::testProblemReporter()
+{
+    CargoProblemReporter reporter;
+
+    CargoDiagnostic unused;
+    unused.level = QStringLiteral("warning");
+    unused.message = QStringLiteral("unused variable: `x`");
+    unused.file = Path(QStringLiteral("/tmp/project/src/lib.rs"));
+    unused.line = 2;
+    unused.column = 8;
+    unused.endLine = 2;
+    unused.endColumn = 9;
+
+    CargoDiagnostic dead = unused;
+    dead.message = QStringLiteral("function is never used: `f`");
+    dead.line = 5;
+
+    // The same warning is reported once for the library and once for its tests
+    int build = reporter.beginBuild(Path(QStringLiteral("/tmp/project")));
+    reporter.addDiagnostics(build, {unused, dead});
+    reporter.addDiagnostics(build, {unused});
+    reporter.endBuild(build, true);
+    QCOMPARE(reporter.problems().size(), 2);
+
+    // Interrupted builds do not remove anything
+    build = reporter.beginBuild(Path(QStringLiteral("/tmp/project")));
+    reporter.addDiagnostics(build, {unused});
+    reporter.endBuild(build, false);
+    QCOMPARE(reporter.problems().size(), 2);
+
+    // Complete builds remove what they did not report again
+    build = reporter.beginBuild(Path(QStringLiteral("/tmp/project")));
+    reporter.addDiagnostics(build, {unused});
+    reporter.endBuild(build, true);
+    QCOMPARE(reporter.problems().size(), 1);
+    QCOMPARE(reporter.problems().first()->description(), unused.message);
+    QCOMPARE(reporter.problems().first()->finalLocation().start().line(), 2);
+}
+
+void CargoPluginTest::testFindPackage()
+{
+    const Path root(QStringLiteral(CARGO_TESTS_PROJECTS_DIR "/kdev-cargo-test"));
+    const Path manifest = CargoManifest::findPackageManifest(Path(root, QStringLiteral("src/lib.rs")), root);
+
+    QCOMPARE(manifest, Path(root, QStringLiteral("Cargo.toml")));
+    QCOMPARE(CargoManifest::packageName(manifest), QStringLiteral("kdev-cargo-test"));
+
+    QCOMPARE(CargoManifest::targetArguments(Path(root, QStringLiteral("src/lib.rs")), root, QStringLiteral("pkg")),
+             QStringList({ QStringLiteral("--lib") }));
+    QCOMPARE(CargoManifest::targetArguments(Path(root, QStringLiteral("src/main.rs")), root, QStringLiteral("pkg")),
+             QStringList({ QStringLiteral("--bin"), QStringLiteral("pkg") }));
+    QCOMPARE(CargoManifest::targetArguments(Path(root, QStringLiteral("src/bin/tool/cli.rs")), root, QStringLiteral("pkg")),
+             QStringList({ QStringLiteral("--bin"), QStringLiteral("tool") }));
+    QCOMPARE(CargoManifest::targetArguments(Path(root, QStringLiteral("tests/integration.rs")), root, QStringLiteral("pkg")),
+             QStringList({ QStringLiteral("--test"), QStringLiteral("integration") }));
+    QVERIFY(CargoManifest::targetArguments(Path(root, QStringLiteral("src/module.rs")), root, QStringLiteral("pkg")).isEmpty());
+
+    // The search does not leave the project
+    QVERIFY(!CargoManifest::findPackageManifest(Path(root, QStringLiteral("src/lib.rs")), Path(root, QStringLiteral("src"))).isValid());
+}
+
+void CargoPluginTest::testParseMetadata()
+{
+    const QByteArray metadata = "{\"packages\":[{\"name\":\"app\",\"manifest_path\":\"/ws/app/Cargo.toml\","
+        "\"targets\":[{\"kind\":[\"lib\"],\"name\":\"app\",\"src_path\":\"/ws/app/src/lib.rs\"},"
+        "{\"kind\":[\"bin\"],\"name\":\"tool\",\"src_path\":\"/ws/app/src/tool.rs\"},"
+        "{\"kind\":[\"custom-build\"],\"name\":\"build-script-build\",\"src_path\":\"/ws/app/build.rs\"}]}],"
+        "\"target_directory\":\"/ws/target\"}";
+
+    const CargoWorkspace workspace = CargoWorkspace::fromJson(QJsonDocument::fromJson(metadata).object());
+    QCOMPARE(workspace.targetDirectory, Path(QStringLiteral("/ws/target")));
+    QCOMPARE(workspace.packages.size(), 1);
+
+    const CargoPackage* package = workspace.packageInDirectory(Path(QStringLiteral("/ws/app")));
+    QVERIFY(package);
+    QCOMPARE(package->targets.size(), 2);
+    QCOMPARE(package->targets[0].arguments(), QStringList({ QStringLiteral("--lib") }));
+    QCOMPARE(package->targets[1].arguments(), QStringList({ QStringLiteral("--bin"), QStringLiteral("tool") }));
+}
+
+void CargoPluginTest::testCache()
+{
+    QTemporaryDir dir;
+    const QString manifest = dir.path() + QStringLiteral("/Cargo.toml");
+    const QString lock = dir.path() + QStringLiteral("/Cargo.lock");
+
+    QFile file(manifest);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("[package]\nname = \"a\"\n");
+    file.close();
+
+    QJsonObject data;
+    data.insert(QStringLiteral("key"), QStringLiteral("value"));
+
+    CargoCache cache(dir.path() + QStringLiteral("/target/kdevelop/cache.json"));
+    QVERIFY(cache.load().isEmpty());
+    QVERIFY(cache.store(data, { manifest, lock }));
+    QCOMPARE(cache.load(), data);
+
+    // Rewriting the same contents keeps the cache valid
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("[package]\nname = \"a\"\n");
+    file.close();
+    QCOMPARE(cache.load(), data);
+
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("[package]\nname = \"b\"\n");
+    file.close();
+    QVERIFY(cache.load().isEmpty());
+
+    // A dependency that did not exist before also invalidates the cache
+    QVERIFY(cache.store(data, { manifest, lock }));
+    QFile lockFile(lock);
+    QVERIFY(lockFile.open(QIODevice::WriteOnly));
+    lockFile.close();
+    QVERIFY(cache.load().isEmpty());
+
+    // Without hashes, rewriting the same contents at a later time invalidates the cache
+    QVERIFY(cache.store(data, { manifest, lock }, CargoCache::CompareTimestamps));
+    QCOMPARE(cache.load(), data);
+    QTest::qWait(10);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("[package]\nname = \"b\"\n");
+    file.close();
+    QVERIFY(cache.load().isEmpty());
+}
+
+void CargoPluginTest::testReadTestExecutable()
+{
+    IProject* project = loadProject(QStringLiteral("kdev-cargo-test"));
+    QVERIFY(project);
+
+    CargoPlugin* plugin = m_plugin;
+
+    CargoBuildJob* job = new CargoBuildJob(plugin, project->projectItem(), QStringLiteral("test"));
+    job->setJsonDiagnostics(true);
+    job->setRunArguments({ QStringLiteral("--all"), QStringLiteral("--no-run") });
+    job->setStandardViewType(KDevelop::IOutputView::BuildView);
+    job->setAutoDelete(false);
+    QVERIFY(static_cast<KJob*>(job)->exec());
+
+    QString executable;
+    for (const auto& artifact : job->artifacts())
+    {
+        if (artifact.test && artifact.executable.isValid())
+        {
+            executable = artifact.executable.toLocalFile();
+        }
+    }
+    delete job;
+    QVERIFY(!executable.isEmpty());
+
+    CargoElfTestReader reader(executable);
+    if (!reader.read(project->path()))
+    {
+        QSKIP("Test executables of this toolchain cannot be read, they are listed instead");
+    }
+
+    QCOMPARE(reader.cases(), QStringList({
+        QStringLiteral("tests::fails"),
+        QStringLiteral("tests::is_ignored_and_fails"),
+        QStringLiteral("tests::is_ignored_and_passes"),
+        QStringLiteral("tests::passes"),
+        QStringLiteral("tests::should_fail_and_fails"),
+        QStringLiteral("tests::should_fail_and_passes"),
+    }));
+    QVERIFY(reader.ignoredCasesKnown());
+    QCOMPARE(reader.ignoredCases(), QStringList({
+        QStringLiteral("tests::is_ignored_and_fails"),
+        QStringLiteral("tests::is_ignored_and_passes"),
+    }));
+
+    // Other files are never mistaken for test executables
+    CargoElfTestReader manifestReader(project->path().toLocalFile() + QStringLiteral("/Cargo.toml"));
+    QVERIFY(!manifestReader.read(project->path()));
+
+    // Neither are programs, which have functions and strings but no test array
+    IProject* binProject = loadProject(QStringLiteral("kdev-cargo-bin"));
+    QVERIFY(binProject);
+    job = new CargoBuildJob(plugin, binProject->projectItem(), QStringLiteral("build"));
+    job->setJsonDiagnostics(true);
+    job->setStandardViewType(KDevelop::IOutputView::BuildView);
+    job->setAutoDelete(false);
+    QVERIFY(static_cast<KJob*>(job)->exec());
+
+    QString program;
+    for (const auto& artifact : job->artifacts())
+    {
+        if (artifact.kinds.contains(QStringLiteral("bin")) && artifact.executable.isValid())
+        {
+            program = artifact.executable.toLocalFile();
+        }
+    }
+    delete job;
+    QVERIFY(!program.isEmpty());
+    CargoElfTestReader programReader(program);
+    QVERIFY(!programReader.read(binProject->path()));
+
+    // Without ignored tests, no byte of the descriptors can be told to be the ignore flag
+    job = new CargoBuildJob(plugin, binProject->projectItem(), QStringLiteral("test"));
+    job->setJsonDiagnostics(true);
+    job->setRunArguments({ QStringLiteral("--lib"), QStringLiteral("--no-run") });
+    job->setStandardViewType(KDevelop::IOutputView::BuildView);
+    job->setAutoDelete(false);
+    QVERIFY(static_cast<KJob*>(job)->exec());
 
+    QString libTests;
+    for (const auto& artifact : job->artifacts())
+    {
+        if (artifact.test && artifact.executable.isValid())
+        {
+            libTests = artifact.executable.toLocalFile();
+        }
+    }
+    delete job;
+    QVERIFY(!libTests.isEmpty());
+    CargoElfTestReader libTestsReader(libTests);
+    QVERIFY(libTestsReader.read(binProject->path()));
+    QCOMPARE(libTestsReader.cases().size(), 1);
+    QVERIFY(!libTestsReader.ignoredCasesKnown());
+}
 
 QTEST_MAIN(CargoPluginTest);
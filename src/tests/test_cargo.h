@@ -39,10 +39,36 @@ private Q_SLOTS:
 
     void testOpenProject();
     void testBuildProject();
+    void testSkipBuildOutput();
     void testFindTests();
+    void testFindSameNamedTargets();
+    void testDiscoveryProcesses();
+    void testListingCache();
     void testRunTests();
+    void testRunReportsOnce();
+    void testRunTimeouts();
     void testRunSingleCases();
     void testRunIgnoredCases();
+    void testRunSelectedCases();
+    void testTestScheduler();
+    void testRunSuitesInParallel();
+    void testRunShardedSuite();
+    void testTestHistory();
+    void testTestOrder();
+    void testDepInfoIndex();
+    void testTestCaseTree();
+    void testBenchmarkResults();
+    void testRepeatCases();
+    void testStackDump();
+    void testParseJsonMessages();
+    void testBoundedOutput();
+    void testBuildJobOutput();
+    void testClassifiedItems();
+    void testProblemReporter();
+    void testFindPackage();
+    void testParseMetadata();
+    void testCache();
+    void testReadTestExecutable();
 
 private:
     CargoPlugin* m_plugin;